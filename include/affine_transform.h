@@ -0,0 +1,91 @@
+#ifndef AFFINE_TRANSFORM_H
+#define AFFINE_TRANSFORM_H
+
+#include <cmath>
+
+/**
+ * @brief 2D affine transform mapping destination pixel coordinates to source pixel coordinates.
+ * 
+ * A destination pixel (x, y) samples the source at
+ * (xx * x + xy * y + x0, yx * x + yy * y + y0). Transforms are expressed in this inverse
+ * direction because the resizers walk the destination grid and look up the source.
+ */
+
+struct affine_transform {
+    double xx = 1.0;
+    double xy = 0.0;
+    double x0 = 0.0;
+    double yx = 0.0;
+    double yy = 1.0;
+    double y0 = 0.0;
+
+    /**
+     * @brief Creates the identity transform.
+     */
+    static affine_transform identity() {
+        return affine_transform{};
+    }
+
+    /**
+     * @brief Creates a scaling transform.
+     * 
+     * @param x_ratio Source pixels per destination pixel along x.
+     * @param y_ratio Source pixels per destination pixel along y.
+     */
+    static affine_transform scale(double x_ratio, double y_ratio) {
+        return affine_transform{x_ratio, 0.0, 0.0, 0.0, y_ratio, 0.0};
+    }
+
+    /**
+     * @brief Creates a translation transform.
+     * 
+     * @param dx Offset added to the source x-coordinate.
+     * @param dy Offset added to the source y-coordinate.
+     */
+    static affine_transform translation(double dx, double dy) {
+        return affine_transform{1.0, 0.0, dx, 0.0, 1.0, dy};
+    }
+
+    /**
+     * @brief Creates a rotation around a point of the source image.
+     * 
+     * @param angle The rotation angle in radians, counter-clockwise as seen on screen.
+     * @param cx The x-coordinate of the rotation centre.
+     * @param cy The y-coordinate of the rotation centre.
+     */
+    static affine_transform rotation(double angle, double cx, double cy) {
+        double c = std::cos(angle);
+        double s = std::sin(angle);
+        return translation(cx, cy) * affine_transform{c, -s, 0.0, s, c, 0.0} * translation(-cx, -cy);
+    }
+
+    /**
+     * @brief Composes two transforms.
+     * 
+     * @param other The transform applied first.
+     * @return affine_transform The transform applying other, then this one.
+     */
+    affine_transform operator*(const affine_transform& other) const {
+        return affine_transform{
+            xx * other.xx + xy * other.yx, xx * other.xy + xy * other.yy, xx * other.x0 + xy * other.y0 + x0,
+            yx * other.xx + yy * other.yx, yx * other.xy + yy * other.yy, yx * other.x0 + yy * other.y0 + y0};
+    }
+
+    /**
+     * @brief Computes the inverse transform, e.g. to turn a source-to-destination mapping
+     * into the destination-to-source mapping used by the resizers.
+     * 
+     * @return affine_transform The inverse transform. The result is undefined if the
+     * transform is singular.
+     */
+    affine_transform inverse() const {
+        double det = xx * yy - xy * yx;
+        double ixx = yy / det;
+        double ixy = -xy / det;
+        double iyx = -yx / det;
+        double iyy = xx / det;
+        return affine_transform{ixx, ixy, -(ixx * x0 + ixy * y0), iyx, iyy, -(iyx * x0 + iyy * y0)};
+    }
+};
+
+#endif // AFFINE_TRANSFORM_H
@@ -0,0 +1,42 @@
+#ifndef CIMG_ADAPTER_H
+#define CIMG_ADAPTER_H
+
+#include "CImg.h"
+#include "image_view.h"
+#include <string>
+
+/**
+ * @brief Bridges CImg images, used for file I/O, and the image views the resizers work on.
+ * 
+ * This is the only place where the resizers meet CImg; its large header stays out of the
+ * kernel translation units.
+ */
+
+/**
+ * @brief Returns a writable view of the pixels of a CImg image (of depth 1).
+ */
+inline image_view view_of(cimg_library::CImg<unsigned char>& image) {
+    return image_view::planar(image.data(), image.width(), image.height(), image.spectrum());
+}
+
+/**
+ * @brief Returns a read-only view of the pixels of a CImg image (of depth 1).
+ */
+inline const_image_view view_of(const cimg_library::CImg<unsigned char>& image) {
+    return const_image_view::planar(image.data(), image.width(), image.height(), image.spectrum());
+}
+
+/**
+ * @brief Saves an image as a binary PGM (one channel) or PPM (three channels).
+ * 
+ * The planes are interleaved with the SIMD routines of pixel_layout.h rather than CImg's
+ * per-pixel loop; the file is the same as the one CImg::save_pnm writes.
+ * 
+ * @param image The image to save.
+ * @param path The path of the file.
+ * @throw std::invalid_argument If the image has neither one nor three channels.
+ * @throw std::runtime_error If the file cannot be written.
+ */
+void save_pnm(const cimg_library::CImg<unsigned char>& image, const std::string& path);
+
+#endif // CIMG_ADAPTER_H
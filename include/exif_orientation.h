@@ -0,0 +1,60 @@
+#ifndef EXIF_ORIENTATION_H
+#define EXIF_ORIENTATION_H
+
+#include "affine_transform.h"
+#include "image_view.h"
+#include <string>
+
+/**
+ * @brief Reads the EXIF orientation tag of a JPEG file.
+ * 
+ * Only the marker segments preceding the image data are read, so this is cheap compared
+ * to decoding the image.
+ * 
+ * @param path The path of the image file.
+ * @return int The orientation (1 to 8), or 1 if the file is not a JPEG, has no EXIF block
+ * or carries no valid orientation tag.
+ */
+int read_exif_orientation(const std::string& path);
+
+/**
+ * @brief Tells whether displaying an image with the given orientation swaps its width and height.
+ * 
+ * @param orientation The EXIF orientation (1 to 8).
+ * @return bool True for the transposing orientations 5 to 8.
+ */
+bool orientation_swaps_axes(int orientation);
+
+/**
+ * @brief Returns a view of a displayed image in the orientation the image is stored in.
+ * 
+ * The view's axes are the displayed image's axes, permuted for the transposing
+ * orientations and reversed by negative strides for the flipped ones, so resizing a stored
+ * image into it writes the displayed image. Every resizer thereby keeps its own kernels,
+ * and the result is the resize of the stored image, rotated or flipped.
+ * 
+ * @param displayed The image in display orientation.
+ * @param orientation The EXIF orientation (1 to 8).
+ * @return image_view The same pixels, with the dimensions and axes of the stored image.
+ */
+image_view oriented_view(const image_view& displayed, int orientation);
+
+/**
+ * @brief Builds the transform resizing a stored image into its display orientation.
+ * 
+ * The rotation or flip is expressed as a permutation and reversal of the destination
+ * indices, so passing the result to resize_image_base::warp orients and resizes the image
+ * in a single traversal. For orientation 1 the sampling positions are those of resize(),
+ * up to warp stepping them in double where resize() computes them in float; the other
+ * orientations sample the same positions, permuted.
+ * 
+ * @param orientation The EXIF orientation (1 to 8).
+ * @param source_width The width of the stored image.
+ * @param source_height The height of the stored image.
+ * @param new_width The width of the displayed, resized image.
+ * @param new_height The height of the displayed, resized image.
+ * @return affine_transform The mapping from displayed pixels to stored pixels.
+ */
+affine_transform orientation_transform(int orientation, int source_width, int source_height, int new_width, int new_height);
+
+#endif // EXIF_ORIENTATION_H
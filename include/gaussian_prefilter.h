@@ -0,0 +1,49 @@
+#ifndef GAUSSIAN_PREFILTER_H
+#define GAUSSIAN_PREFILTER_H
+
+#include "image_view.h"
+#include <vector>
+
+/**
+ * @brief Gaussian blur applied to the source of a large downscale before it is sampled.
+ * 
+ * Point samplers such as nearest neighbour and bilinear interpolation alias badly once a
+ * destination pixel covers many source pixels. Blurring the source first, with a standard
+ * deviation growing with the ratio, removes the frequencies the destination cannot hold.
+ * The Gaussian is approximated by three successive box blurs whose widths are chosen to
+ * give the requested variance. Each box blur is a running sum, so the cost per pixel is
+ * the same whatever the standard deviation, hence whatever the downscale ratio.
+ */
+class gaussian_prefilter {
+public:
+    /**
+     * @brief Returns the standard deviation suited to a resize by the given ratio of source
+     * pixels per destination pixel: (ratio - 1) / 2, and 0 for ratios of 1 or less.
+     */
+    static float sigma_for(float ratio);
+
+    /**
+     * @brief Blurs a rectangle of the source into the prefilter's buffer.
+     * 
+     * Rows are blurred horizontally with the three box passes fused, then the columns of
+     * all rows are blurred together one pass at a time. Pixels beyond the rectangle are
+     * taken as copies of its edge pixels.
+     * 
+     * @param source The original image.
+     * @param x The first column of the rectangle.
+     * @param y The first row of the rectangle.
+     * @param width The width of the rectangle.
+     * @param height The height of the rectangle.
+     * @param sigma_x The standard deviation of the blur along the rows, in pixels.
+     * @param sigma_y The standard deviation of the blur along the columns, in pixels.
+     * @return const_image_view Planar view of the blurred rectangle, valid until the next
+     * call or the destruction of the prefilter.
+     */
+    const_image_view apply(const const_image_view& source, int x, int y, int width, int height, float sigma_x, float sigma_y);
+
+private:
+    std::vector<unsigned char> pixels_;
+    std::vector<unsigned char> scratch_;
+};
+
+#endif // GAUSSIAN_PREFILTER_H
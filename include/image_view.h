@@ -0,0 +1,101 @@
+#ifndef IMAGE_VIEW_H
+#define IMAGE_VIEW_H
+
+#include <cstddef>
+
+/**
+ * @brief Non-owning view of an 8-bit image with arbitrary strides.
+ * 
+ * The strides give the distance in bytes between horizontally adjacent pixels, vertically
+ * adjacent pixels and the channels of a pixel, so the same view describes planar buffers
+ * (CImg), interleaved buffers (most codecs) or memory-mapped files. This header is all
+ * the resize kernels need to know about images, which keeps them independent of CImg.
+ * 
+ * @tparam T unsigned char for a writable view, const unsigned char for a read-only one.
+ */
+
+template<typename T>
+struct basic_image_view {
+    T* data = nullptr;
+    int width = 0;
+    int height = 0;
+    int spectrum = 0;
+    std::ptrdiff_t x_stride = 0;
+    std::ptrdiff_t row_stride = 0;
+    std::ptrdiff_t channel_stride = 0;
+
+    basic_image_view() = default;
+
+    basic_image_view(T* data, int width, int height, int spectrum, std::ptrdiff_t x_stride, std::ptrdiff_t row_stride, std::ptrdiff_t channel_stride)
+        : data(data), width(width), height(height), spectrum(spectrum), x_stride(x_stride), row_stride(row_stride), channel_stride(channel_stride) {}
+
+    /**
+     * @brief Allows passing a writable view where a read-only one is expected.
+     */
+    template<typename U>
+    basic_image_view(const basic_image_view<U>& other)
+        : data(other.data), width(other.width), height(other.height), spectrum(other.spectrum),
+          x_stride(other.x_stride), row_stride(other.row_stride), channel_stride(other.channel_stride) {}
+
+    /**
+     * @brief Creates a view of a planar buffer laid out like CImg data: one plane per channel.
+     */
+    static basic_image_view planar(T* data, int width, int height, int spectrum) {
+        return basic_image_view(data, width, height, spectrum, 1, width, static_cast<std::ptrdiff_t>(width) * height);
+    }
+
+    /**
+     * @brief Creates a view of an interleaved buffer: the channels of each pixel side by side
+     * (RGBRGB...), as produced by most codecs.
+     * 
+     * @param row_stride The distance in bytes between rows, 0 for rows without padding.
+     */
+    static basic_image_view interleaved(T* data, int width, int height, int spectrum, std::ptrdiff_t row_stride = 0) {
+        return basic_image_view(data, width, height, spectrum, spectrum, row_stride ? row_stride : static_cast<std::ptrdiff_t>(width) * spectrum, 1);
+    }
+
+    T& operator()(int x, int y, int channel) const {
+        return data[x * x_stride + y * row_stride + channel * channel_stride];
+    }
+
+    /**
+     * @brief Returns a pointer to the first sample of a row of a channel.
+     */
+    T* row(int y, int channel) const {
+        return data + y * row_stride + channel * channel_stride;
+    }
+
+    /**
+     * @brief Returns the single-channel view of one channel.
+     */
+    basic_image_view channel(int channel) const {
+        return basic_image_view(data + channel * channel_stride, width, height, 1, x_stride, row_stride, 0);
+    }
+
+    /**
+     * @brief Returns the view of a rectangle of the image, which must lie inside it.
+     */
+    basic_image_view crop(int x, int y, int crop_width, int crop_height) const {
+        return basic_image_view(data + x * x_stride + y * row_stride, crop_width, crop_height, spectrum, x_stride, row_stride, channel_stride);
+    }
+
+    /**
+     * @brief Tells whether the pixels of each row of a channel are contiguous.
+     */
+    bool has_contiguous_rows() const {
+        return x_stride == 1;
+    }
+
+    /**
+     * @brief Tells whether the channels of each pixel are adjacent and in order, as in an
+     * interleaved buffer; single-channel images with contiguous rows always qualify.
+     */
+    bool has_contiguous_pixels() const {
+        return x_stride == spectrum && (channel_stride == 1 || spectrum == 1);
+    }
+};
+
+using image_view = basic_image_view<unsigned char>;
+using const_image_view = basic_image_view<const unsigned char>;
+
+#endif // IMAGE_VIEW_H
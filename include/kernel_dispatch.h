@@ -0,0 +1,27 @@
+#ifndef KERNEL_DISPATCH_H
+#define KERNEL_DISPATCH_H
+
+/**
+ * @brief Marks a hot kernel to be compiled once per x86-64 microarchitecture level.
+ * 
+ * The dynamic loader binds the most capable clone the host supports (AVX-512, AVX2 or
+ * SSE4.2), so a single binary runs everywhere without giving up the wider vectors of
+ * recent CPUs. Elsewhere the kernel is compiled once for the build target.
+ * 
+ * Floating point contraction is disabled in the build so that the FMA capable clones
+ * produce exactly the same pixels as the others.
+ */
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && defined(__linux__)
+#define RESIZE_KERNEL_CLONES __attribute__((target_clones("arch=x86-64-v4", "arch=x86-64-v3", "arch=x86-64-v2", "default")))
+#else
+#define RESIZE_KERNEL_CLONES
+#endif
+
+/**
+ * @brief Names the kernel clone selected on this host.
+ * 
+ * @return const char* The microarchitecture level, e.g. "x86-64-v3", or "default".
+ */
+const char* kernel_target();
+
+#endif // KERNEL_DISPATCH_H
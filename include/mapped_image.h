@@ -0,0 +1,83 @@
+#ifndef MAPPED_IMAGE_H
+#define MAPPED_IMAGE_H
+
+#include "image_view.h"
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief Arrangement of the samples of a raw image file.
+ */
+enum class raw_layout {
+    planar,      ///< One plane per channel, like CImg data
+    interleaved  ///< The channels of each pixel next to each other
+};
+
+/**
+ * @brief Uncompressed image file mapped read-only into memory.
+ * 
+ * The pixels are never copied: the view describes them where they lie in the mapping, with
+ * strides absorbing the layout of the format (interleaved channels, BGR order, bottom-up
+ * rows, row padding). A file already in the page cache is therefore resized without
+ * allocating a second copy of it.
+ * 
+ * Supported formats are BMP (uncompressed, 24 or 32 bits per pixel), binary PGM and PPM
+ * with at most 8 bits per sample, and headerless raw files of known dimensions.
+ */
+
+class mapped_image {
+public:
+    /**
+     * @brief Creates an empty image that maps nothing.
+     */
+    mapped_image();
+
+    /**
+     * @brief Maps a BMP or binary PNM file.
+     * 
+     * @param path The path of the file.
+     * @return mapped_image The mapped image, or an empty one if the file is in another
+     * format (or a variant of these formats that cannot be used in place) and must be decoded.
+     * @throw std::runtime_error If the file cannot be opened or mapped, or is shorter than its
+     * header announces.
+     */
+    static mapped_image open(const std::string& path);
+
+    /**
+     * @brief Maps a headerless file of 8-bit samples.
+     * 
+     * @param path The path of the file.
+     * @param width The image width.
+     * @param height The image height.
+     * @param spectrum The number of channels.
+     * @param layout The arrangement of the samples.
+     * @param offset The number of bytes preceding the samples.
+     * @return mapped_image The mapped image.
+     * @throw std::invalid_argument If a dimension is not positive.
+     * @throw std::runtime_error If the file cannot be opened or mapped, or is too short.
+     */
+    static mapped_image open_raw(const std::string& path, int width, int height, int spectrum, raw_layout layout, std::size_t offset = 0);
+
+    ~mapped_image();
+    mapped_image(mapped_image&& other) noexcept;
+    mapped_image& operator=(mapped_image&& other) noexcept;
+    mapped_image(const mapped_image&) = delete;
+    mapped_image& operator=(const mapped_image&) = delete;
+
+    /**
+     * @brief Returns the view of the mapped pixels, valid as long as this object.
+     */
+    const const_image_view& view() const { return view_; }
+
+    bool empty() const { return mapping_ == nullptr; }
+
+private:
+    mapped_image(const std::string& path);
+    void release();
+
+    unsigned char* mapping_;
+    std::size_t length_;
+    const_image_view view_;
+};
+
+#endif // MAPPED_IMAGE_H
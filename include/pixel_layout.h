@@ -0,0 +1,70 @@
+#ifndef PIXEL_LAYOUT_H
+#define PIXEL_LAYOUT_H
+
+#include "image_view.h"
+#include <cstddef>
+
+/**
+ * @brief Conversions between planar pixels (CImg, one plane per channel) and interleaved
+ * pixels (codecs and file formats, RGBRGB...), and the handling of RGB images holding grey
+ * pixels.
+ * 
+ * 3 and 4-channel images are converted with SSSE3 or AVX2 byte shuffles, picked at run
+ * time; other channel counts, and CPUs without SSSE3, use a scalar loop.
+ */
+
+/**
+ * @brief Interleaves a run of planar pixels.
+ * 
+ * @param planar The first sample of the run in the first plane.
+ * @param plane_stride The distance in bytes between the planes.
+ * @param pixel_count The number of pixels to convert.
+ * @param channels The number of channels.
+ * @param interleaved The buffer receiving pixel_count * channels bytes.
+ */
+void interleave_pixels(const unsigned char* planar, std::ptrdiff_t plane_stride, std::size_t pixel_count, int channels, unsigned char* interleaved);
+
+/**
+ * @brief Splits a run of interleaved pixels into planes.
+ * 
+ * @param interleaved The pixel_count * channels bytes to convert.
+ * @param pixel_count The number of pixels to convert.
+ * @param channels The number of channels.
+ * @param planar The first sample of the run in the first plane.
+ * @param plane_stride The distance in bytes between the planes.
+ */
+void deinterleave_pixels(const unsigned char* interleaved, std::size_t pixel_count, int channels, unsigned char* planar, std::ptrdiff_t plane_stride);
+
+/**
+ * @brief Copies the pixels of an image into another of the same dimensions, converting
+ * between interleaved and planar rows with the routines above.
+ * 
+ * @param source The image to copy.
+ * @param destination The image receiving the pixels, in any layout.
+ * @throw std::invalid_argument If the dimensions of the images differ.
+ */
+void copy_pixels(const const_image_view& source, const image_view& destination);
+
+/**
+ * @brief Tells whether the red, green and blue channels of an image are equal at every
+ * pixel, i.e. whether a colour image actually holds grey pixels.
+ * 
+ * Rows are compared in chunks of pixels with vectorised loops, and the scan stops at the
+ * first chunk holding a colour pixel, so colour images are usually told apart within their
+ * first row.
+ * 
+ * @param image The image to inspect.
+ * @return bool True if the image has at least 3 channels and its first 3 are equal.
+ */
+bool is_grey(const const_image_view& image);
+
+/**
+ * @brief Copies the first channel of an image into its second and third channels, turning
+ * a grey image computed in its first channel only into a colour image.
+ * 
+ * @param image The image to fill, with at least 3 channels.
+ * @throw std::invalid_argument If the image has fewer than 3 channels.
+ */
+void broadcast_grey(const image_view& image);
+
+#endif // PIXEL_LAYOUT_H
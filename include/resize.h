@@ -0,0 +1,39 @@
+#ifndef RESIZE_H
+#define RESIZE_H
+
+/**
+ * @brief Public C++ interface of libresize.
+ * 
+ * Link against libresize.a or libresize.so (make lib) and include this header to resize
+ * images in-process: the resizers themselves (resize_nearest_neighbour, resize_bilinear,
+ * resize_box, the block reductions of resize_reduce and their resize_image_base interface),
+ * summed-area tables serving many box-filtered sizes, file jobs with EXIF orientation and
+ * caching, shared-memory images and the client of the resize service. The library is built without
+ * CImg display support, which this header selects unless cimg_display is already defined.
+ * 
+ * Additions keep existing signatures working; RESIZE_API_VERSION from resize_c_api.h is
+ * raised on every change of the interface.
+ */
+
+#ifndef cimg_display
+#define cimg_display 0
+#endif
+
+#include "resize_c_api.h"
+#include "resize_image_base.h"
+#include "cimg_adapter.h"
+#include "kernel_dispatch.h"
+#include "pixel_layout.h"
+#include "resize_nearest_neighbour.h"
+#include "resize_bilinear.h"
+#include "resize_box.h"
+#include "resize_reduce.h"
+#include "summed_area_table.h"
+#include "exif_orientation.h"
+#include "resize_job.h"
+#include "resize_cache.h"
+#include "shared_image.h"
+#include "mapped_image.h"
+#include "resize_client.h"
+
+#endif // RESIZE_H
@@ -0,0 +1,40 @@
+#ifndef RESIZE_BOX_H
+#define RESIZE_BOX_H
+
+#include "resize_bilinear.h"
+
+/**
+ * @brief Class for resizing images with a box filter.
+ * 
+ * Each destination pixel is the mean of the source pixels under it, read from a
+ * summed_area_table of the pixels the resize covers, so downscales average every source
+ * pixel instead of sampling a few. resize_many builds a single table for all its sizes,
+ * after which each size only costs its own output pixels. Warps have no axis-aligned
+ * footprint to average and are sampled bilinearly, as by resize_bilinear.
+ */
+
+class resize_box : public resize_bilinear {
+public:
+    /**
+     * @brief Resizes a region of the source image directly into the destination image.
+     * 
+     * @param source The original image.
+     * @param region The rectangle of the source image to resize.
+     * @param destination The image receiving the resized region.
+     * @throw std::invalid_argument If a destination pixel covers more than
+     * summed_area_table::max_box_area source pixels.
+     */
+    void resize_region(const const_image_view& source, const image_region& region, const image_view& destination) const override;
+    using resize_image_base::resize_region;
+
+    /**
+     * @brief Resizes an image to several sizes from a single summed-area table.
+     * 
+     * @param source The original image to be resized.
+     * @param destinations The images receiving the resized images.
+     */
+    void resize_many(const const_image_view& source, const std::vector<image_view>& destinations) const override;
+    using resize_image_base::resize_many;
+};
+
+#endif // RESIZE_BOX_H
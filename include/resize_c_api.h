@@ -0,0 +1,114 @@
+#ifndef RESIZE_C_API_H
+#define RESIZE_C_API_H
+
+/**
+ * @brief C interface of libresize, for callers that cannot use the C++ classes.
+ * 
+ * Images are passed as 8-bit buffers, either planar, laid out like CImg<unsigned char> data
+ * (all pixels of the first channel row by row, then those of the next channel), or
+ * interleaved (the channels of each pixel side by side, RGBRGB...). Every function
+ * returns RESIZE_OK on success; on failure resize_last_error() describes the problem.
+ * The functions are thread-safe.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RESIZE_API_VERSION 8
+
+typedef enum {
+    RESIZE_NEAREST = 0,
+    RESIZE_BILINEAR = 1,
+    RESIZE_BOX = 2,
+    RESIZE_MAX = 3,
+    RESIZE_MIN = 4,
+    RESIZE_MODE = 5
+} resize_method;
+
+typedef enum {
+    RESIZE_OK = 0,
+    RESIZE_INVALID_ARGUMENT = 1,
+    RESIZE_IO_ERROR = 2,
+    RESIZE_INTERNAL_ERROR = 3
+} resize_status;
+
+/**
+ * @brief Returns the RESIZE_API_VERSION the library was built with.
+ */
+int resize_api_version(void);
+
+/**
+ * @brief Resizes a planar image held in memory.
+ * 
+ * @param method The interpolation method.
+ * @param source The source pixels, width * height * spectrum bytes.
+ * @param width The source width.
+ * @param height The source height.
+ * @param spectrum The number of channels.
+ * @param destination The buffer receiving new_width * new_height * spectrum bytes.
+ * @param new_width The desired width.
+ * @param new_height The desired height.
+ * @return resize_status RESIZE_OK, or RESIZE_INVALID_ARGUMENT.
+ */
+resize_status resize_planar(resize_method method, const unsigned char* source, int width, int height, int spectrum,
+                            unsigned char* destination, int new_width, int new_height);
+
+/**
+ * @brief Resizes an interleaved image held in memory, without converting it to planar.
+ * 
+ * @param method The interpolation method.
+ * @param source The source pixels.
+ * @param width The source width.
+ * @param height The source height.
+ * @param channels The number of channels of each pixel.
+ * @param source_row_stride The distance in bytes between source rows, or 0 for width * channels.
+ * @param destination The buffer receiving the resized pixels.
+ * @param new_width The desired width.
+ * @param new_height The desired height.
+ * @param destination_row_stride The distance in bytes between destination rows, or 0 for
+ * new_width * channels.
+ * @return resize_status RESIZE_OK, or RESIZE_INVALID_ARGUMENT.
+ */
+resize_status resize_interleaved(resize_method method, const unsigned char* source, int width, int height, int channels, int source_row_stride,
+                                 unsigned char* destination, int new_width, int new_height, int destination_row_stride);
+
+/**
+ * @brief Loads, resizes and saves an image file, applying its EXIF orientation.
+ * 
+ * Errors are reported through resize_last_error. The CImg exception mode, which decides
+ * whether CImg also prints them, is process-wide and left as the host application set it.
+ * 
+ * @param method The interpolation method.
+ * @param input The input path.
+ * @param output The output path; its extension selects the format.
+ * @param new_width The desired width, or 0 to follow the aspect ratio.
+ * @param new_height The desired height, or 0 to follow the aspect ratio.
+ * @param quality The JPEG quality, from 1 to 100.
+ * @return resize_status RESIZE_OK, RESIZE_INVALID_ARGUMENT or RESIZE_IO_ERROR.
+ */
+resize_status resize_file(resize_method method, const char* input, const char* output, int new_width, int new_height, int quality);
+
+/**
+ * @brief Sets whether the later resizes of the calling thread prefilter large downscales.
+ * 
+ * Downscales by more than 2 on an axis then blur the source before sampling it, which
+ * removes the aliasing of nearest neighbour and bilinear sampling. The setting applies to
+ * every function above, is kept per thread and is off by default.
+ * 
+ * @param enabled Nonzero to prefilter.
+ */
+void resize_set_antialiasing(int enabled);
+
+/**
+ * @brief Describes the last error of the calling thread.
+ * 
+ * @return const char* The message, valid until the thread's next call into the library.
+ */
+const char* resize_last_error(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RESIZE_C_API_H
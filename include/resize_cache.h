@@ -0,0 +1,113 @@
+#ifndef RESIZE_CACHE_H
+#define RESIZE_CACHE_H
+
+#include "CImg.h"
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/**
+ * @brief Counters describing the activity of a resize_cache.
+ */
+struct resize_cache_stats {
+    std::uint64_t memory_hits = 0;
+    std::uint64_t disk_hits = 0;
+    std::uint64_t misses = 0;
+    std::size_t memory_bytes = 0;
+    std::size_t disk_bytes = 0;
+};
+
+/**
+ * @brief Two-tier cache of resized images, keyed on the content of their source.
+ * 
+ * Results are looked up first in an in-memory LRU tier, then in an on-disk tier whose
+ * entries survive restarts; a disk hit is promoted to memory. Each tier evicts its least
+ * recently used entries to stay within its byte budget. All methods are thread-safe.
+ */
+
+class resize_cache {
+public:
+    using image_ptr = std::shared_ptr<const cimg_library::CImg<unsigned char>>;
+
+    /**
+     * @brief Creates a cache.
+     * 
+     * @param memory_budget The maximum number of pixel bytes kept in memory, 0 to disable the tier.
+     * @param disk_directory The directory of the disk tier, empty to disable it. It is created
+     * if needed, and entries already in it are reused.
+     * @param disk_budget The maximum number of bytes kept on disk.
+     */
+    resize_cache(std::size_t memory_budget, const std::string& disk_directory, std::size_t disk_budget);
+
+    /**
+     * @brief Computes a fast, non-cryptographic 64-bit hash of a buffer.
+     */
+    static std::uint64_t hash_bytes(const void* data, std::size_t size);
+
+    /**
+     * @brief Hashes the content of a file.
+     * 
+     * @throw std::runtime_error If the file cannot be read.
+     */
+    static std::uint64_t hash_file(const std::string& path);
+
+    /**
+     * @brief Builds the key of a resize result.
+     * 
+     * @param content_hash The hash of the source content.
+     * @param parameters Everything else the result depends on (method, requested size...).
+     * It must be usable in a file name.
+     */
+    static std::string make_key(std::uint64_t content_hash, const std::string& parameters);
+
+    /**
+     * @brief Looks a result up.
+     * 
+     * @param key The key of the result.
+     * @return image_ptr The cached image, or null on a miss.
+     */
+    image_ptr lookup(const std::string& key);
+
+    /**
+     * @brief Stores a result in both tiers, evicting older entries as needed.
+     * 
+     * @param key The key of the result.
+     * @param image The resized image.
+     */
+    void store(const std::string& key, const cimg_library::CImg<unsigned char>& image);
+
+    /**
+     * @brief Returns the hit and miss counters and the current size of both tiers.
+     */
+    resize_cache_stats stats() const;
+
+private:
+    struct memory_entry {
+        std::string key;
+        image_ptr image;
+    };
+    struct disk_entry {
+        std::size_t bytes;
+        std::list<std::string>::iterator position;
+    };
+
+    void store_in_memory(const std::string& key, image_ptr image);
+    void touch_on_disk(const std::string& key);
+    std::string disk_path(const std::string& key) const;
+
+    std::size_t memory_budget_;
+    std::string disk_directory_;
+    std::size_t disk_budget_;
+
+    mutable std::mutex mutex_;
+    std::list<memory_entry> memory_lru_;
+    std::unordered_map<std::string, std::list<memory_entry>::iterator> memory_index_;
+    std::list<std::string> disk_lru_;
+    std::unordered_map<std::string, disk_entry> disk_index_;
+    resize_cache_stats stats_;
+};
+
+#endif // RESIZE_CACHE_H
@@ -0,0 +1,68 @@
+#ifndef RESIZE_CLIENT_H
+#define RESIZE_CLIENT_H
+
+#include "resize_job.h"
+#include "resize_protocol.h"
+#include "shared_image.h"
+#include <string>
+
+/**
+ * @brief Client of the resize service started with resize_image --serve.
+ * 
+ * Pixels are exchanged as shared_image objects, so an in-memory pipeline can hand its
+ * decoded images to the service and read the results back without any encoding, disk I/O
+ * or copy. One client holds one connection and is not meant to be shared between threads.
+ */
+
+class resize_client {
+public:
+    /**
+     * @brief Connects to the service.
+     * 
+     * @param socket_path The path of the service's Unix domain socket.
+     * @throw std::runtime_error If the connection fails.
+     */
+    explicit resize_client(const std::string& socket_path);
+
+    ~resize_client();
+    resize_client(const resize_client&) = delete;
+    resize_client& operator=(const resize_client&) = delete;
+
+    /**
+     * @brief Resizes an image held in shared memory.
+     * 
+     * @param source The image to resize.
+     * @param method The resize method, "nearest", "bilinear", "box", "max", "min" or "mode".
+     * @param new_width The desired width of the resized image.
+     * @param new_height The desired height of the resized image.
+     * @return shared_image The resized image, mapped read-only.
+     * @throw std::runtime_error If the service reports an error or the connection fails.
+     */
+    shared_image resize(const shared_image& source, const std::string& method, int new_width, int new_height);
+
+    /**
+     * @brief Has the service load, resize and save a file.
+     * 
+     * @param job The job, with an output path.
+     * @return image_size The dimensions of the saved image.
+     * @throw std::runtime_error If the service reports an error or the connection fails.
+     */
+    image_size resize_file(const resize_job& job);
+
+    /**
+     * @brief Has the service load and resize a file, returning the pixels instead of saving them.
+     * 
+     * @param job The job; its output path and quality are ignored.
+     * @return shared_image The resized image, mapped read-only.
+     * @throw std::runtime_error If the service reports an error or the connection fails.
+     */
+    shared_image load_resized(const resize_job& job);
+
+private:
+    resize_protocol::frame request(std::uint16_t type, const std::vector<unsigned char>& payload, int fd);
+    shared_image send_resize_file(const resize_job& job, const std::string& output, image_size& size);
+
+    int socket_;
+};
+
+#endif // RESIZE_CLIENT_H
@@ -0,0 +1,63 @@
+#ifndef RESIZE_EXACT_H
+#define RESIZE_EXACT_H
+
+#include "image_view.h"
+#include "resize_image_base.h"
+
+/**
+ * @brief Resize ratios handled by the dedicated integer kernels.
+ */
+enum class exact_ratio {
+    none,   ///< Any other ratio, resized by the generic kernels
+    half,   ///< Exactly two source pixels per destination pixel on both axes
+    twice   ///< Exactly two destination pixels per source pixel on both axes
+};
+
+/**
+ * @brief Detects the ratios of a resize that the integer kernels handle.
+ *
+ * The region must start on a pixel boundary, so that the samples fall on source pixels or
+ * exactly halfway between two of them.
+ *
+ * @param region The clipped region being resized.
+ * @param x_ratio The source columns per destination column.
+ * @param y_ratio The source rows per destination row.
+ * @return exact_ratio The ratio, or exact_ratio::none.
+ */
+exact_ratio detect_exact_ratio(const image_region& region, float x_ratio, float y_ratio);
+
+/**
+ * @brief Fills the columns [x_begin, x_end) of a destination row with a halving resize.
+ *
+ * Every sample of a halving resize lands on a source pixel, so both nearest neighbour and
+ * bilinear interpolation reduce to taking every other pixel of every other row.
+ *
+ * @param source The original image.
+ * @param x0 The first column of the region.
+ * @param y0 The first row of the region.
+ * @param y The destination row.
+ * @param x_begin The first destination column.
+ * @param x_end The destination column past the end of the span.
+ * @param destination The image receiving the resized region.
+ */
+void halve_span(const const_image_view& source, int x0, int y0, int y, int x_begin, int x_end, const image_view& destination);
+
+/**
+ * @brief Fills the columns [x_begin, x_end) of a destination row with a bilinear doubling resize.
+ *
+ * Every bilinear weight of a doubling resize is 0 or 1/2, so each destination pixel is the
+ * floored average of one, two or four source pixels, exactly as the float kernel truncates it.
+ *
+ * @param source The original image.
+ * @param x0 The first column of the region.
+ * @param y0 The first row of the region.
+ * @param x_last The last source column overlapping the region.
+ * @param y_last The last source row overlapping the region.
+ * @param y The destination row.
+ * @param x_begin The first destination column.
+ * @param x_end The destination column past the end of the span.
+ * @param destination The image receiving the resized region.
+ */
+void double_span(const const_image_view& source, int x0, int y0, int x_last, int y_last, int y, int x_begin, int x_end, const image_view& destination);
+
+#endif // RESIZE_EXACT_H
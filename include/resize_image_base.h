@@ -1,13 +1,48 @@
 #ifndef RESIZE_IMAGE_BASE_H
 #define RESIZE_IMAGE_BASE_H
 
-#include "CImg.h"
+#include "image_view.h"
+#include "affine_transform.h"
+#include "gaussian_prefilter.h"
+#include "resize_kernels.h"
+#include "resize_tiles.h"
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+// CImg is only needed by the callers of the CImg overloads, which include CImg.h themselves
+namespace cimg_library {
+template<typename T> struct CImg;
+}
+
+/**
+ * @brief Rectangle of the source image to sample from, in source pixel coordinates.
+ *
+ * The origin may be fractional so that sub-pixel crops (e.g. from a face detector)
+ * can be resized without rounding the box first.
+ */
+struct image_region {
+    float x;
+    float y;
+    float width;
+    float height;
+};
+
+/**
+ * @brief Dimensions of an output image.
+ */
+struct image_size {
+    int width;
+    int height;
+};
 
 /**
  * @brief Abstract base class for image resizing.
  * 
  * This class provides an interface for resizing images. Derived classes must implement
- * the resize method to provide specific resizing algorithms.
+ * the resize_region method to provide specific resizing algorithms. The algorithms work
+ * on image views; the CImg overloads, defined in cimg_adapter.cpp, wrap CImg images into
+ * views.
  */
 
 class resize_image_base {
@@ -18,19 +53,222 @@ public:
     virtual ~resize_image_base() = default;
 
     /**
-     * @brief Pure virtual method to resize an image.
+     * @brief Pure virtual method to resize a region of an image directly into an output image.
+     * 
+     * Only the pixels covered by the region are sampled, so cropping and resizing happen
+     * in a single pass without materialising the crop. The output dimensions are those of
+     * the destination image, which must have the same spectrum as the source.
+     * 
+     * @param source The original image.
+     * @param region The rectangle of the source image to resize.
+     * @param destination The image receiving the resized region.
+     */
+    virtual void resize_region(const const_image_view& source, const image_region& region, const image_view& destination) const = 0;
+
+    /**
+     * @brief Resizes a whole image into an output image.
+     * 
+     * @param source The original image to be resized.
+     * @param destination The image receiving the resized image.
+     */
+    void resize(const const_image_view& source, const image_view& destination) const {
+        resize_region(source, image_region{0.0f, 0.0f, static_cast<float>(source.width), static_cast<float>(source.height)}, destination);
+    }
+
+    /**
+     * @brief Sets how resize_region and warp split the destination into cache-sized tiles
+     * and how many threads process them.
+     * 
+     * The shared resizers of resizer_for keep the default of one thread; jobs, the command
+     * line and the resize service get resizers of their own from create_resizer, tiled with
+     * the tile threads of the job.
+     * 
+     * @param options The tiling options.
+     */
+    void set_tiling(const tile_options& options) {
+        tiling_ = options;
+    }
+
+    /**
+     * @brief Returns the tiling options used by resize_region and warp.
+     */
+    const tile_options& tiling() const {
+        return tiling_;
+    }
+
+    /**
+     * @brief Sets how warp samples around and beyond the edges of the source.
+     * 
+     * Resizes sample corner-aligned positions that never reach past the last pixel, so
+     * only warps depend on it.
+     * 
+     * @param edges The edge mode.
+     */
+    void set_edge_mode(edge_mode edges) {
+        edges_ = edges;
+    }
+
+    /**
+     * @brief Returns the edge mode used by warp.
+     */
+    edge_mode edges() const {
+        return edges_;
+    }
+
+    /**
+     * @brief Enables the Gaussian prefilter of large downscales.
+     * 
+     * When enabled, resize_region blurs the pixels under the region before sampling them
+     * whenever it shrinks the region by more than 2 on an axis, with the standard
+     * deviation given by gaussian_prefilter::sigma_for on each axis. This prevents the
+     * aliasing of point sampling at a cost per source pixel independent of the ratio.
+     * Warps sample the source directly.
+     * 
+     * @param enabled Whether to prefilter large downscales.
+     */
+    void set_antialiasing(bool enabled) {
+        antialiasing_ = enabled;
+    }
+
+    /**
+     * @brief Tells whether large downscales are prefiltered.
+     */
+    bool antialiasing() const {
+        return antialiasing_;
+    }
+
+    /**
+     * @brief Resizes an image to several sizes.
+     * 
+     * Each size goes through resize_region with its tables, row kernels and tiles, so the
+     * results are those of resize(). Resizers able to share work between sizes override
+     * it: nearest neighbour and bilinear read the source rows once for all sizes, and
+     * resize_box builds a single summed-area table.
+     * 
+     * @param source The original image to be resized.
+     * @param destinations The images receiving the resized images.
+     */
+    virtual void resize_many(const const_image_view& source, const std::vector<image_view>& destinations) const;
+
+    /**
+     * @brief Warps the source image with an affine transform directly into the destination image.
      * 
-     * Derived classes must implement this method to resize the given source image
-     * to the specified new dimensions.
+     * Source coordinates are stepped incrementally along each destination row, so rotation,
+     * scaling and translation happen in a single pass. Each row is split into an interior
+     * span, whose samples only read pixels inside the source and go through the resizer's
+     * warp_inside without any edge handling, and the border around it, sampled with
+     * estimate_color under the edge mode. With the clamp edge mode, spans of a row mapping
+     * outside the source image are skipped and keep the destination's existing values;
+     * mirror and wrap sample the reflected or repeated image there instead. Rows are split
+     * into tiles as set by set_tiling.
+     * 
+     * @param source The original image.
+     * @param transform The mapping from destination to source pixel coordinates.
+     * @param destination The image receiving the warped result.
+     */
+    void warp(const const_image_view& source, const affine_transform& transform, const image_view& destination) const;
+
+    /**
+     * @brief Resizes the given source image to the specified new dimensions.
      * 
      * @param source The original image to be resized.
      * @param new_width The desired width of the resized image.
      * @param new_height The desired height of the resized image.
      * @return cimg_library::CImg<unsigned char> The resized image.
      */
-    virtual cimg_library::CImg<unsigned char> resize(const cimg_library::CImg<unsigned char>& source, int new_width, int new_height) const = 0;
+    cimg_library::CImg<unsigned char> resize(const cimg_library::CImg<unsigned char>& source, int new_width, int new_height) const;
+
+    /**
+     * @brief Resizes a region of a CImg image directly into another CImg image.
+     * 
+     * @param source The original image.
+     * @param region The rectangle of the source image to resize.
+     * @param destination The image receiving the resized region.
+     */
+    void resize_region(const cimg_library::CImg<unsigned char>& source, const image_region& region, cimg_library::CImg<unsigned char>& destination) const;
+
+    /**
+     * @brief Resizes a region of an image to the specified new dimensions.
+     * 
+     * @param source The original image.
+     * @param region The rectangle of the source image to resize.
+     * @param new_width The desired width of the resized region.
+     * @param new_height The desired height of the resized region.
+     * @return cimg_library::CImg<unsigned char> The resized region.
+     */
+    cimg_library::CImg<unsigned char> resize_region(const cimg_library::CImg<unsigned char>& source, const image_region& region, int new_width, int new_height) const;
+
+    /**
+     * @brief Resizes a CImg image to several sizes with resize_many.
+     * 
+     * @param source The original image to be resized.
+     * @param sizes The desired dimensions of the resized images.
+     * @return std::vector<cimg_library::CImg<unsigned char>> The resized images, in the order of sizes.
+     */
+    std::vector<cimg_library::CImg<unsigned char>> resize_many(const cimg_library::CImg<unsigned char>& source, const std::vector<image_size>& sizes) const;
+
+    /**
+     * @brief Warps a CImg image with an affine transform directly into another CImg image.
+     * 
+     * @param source The original image.
+     * @param transform The mapping from destination to source pixel coordinates.
+     * @param destination The image receiving the warped result.
+     */
+    void warp(const cimg_library::CImg<unsigned char>& source, const affine_transform& transform, cimg_library::CImg<unsigned char>& destination) const;
+
+    /**
+     * @brief Warps the source image with an affine transform into a new image.
+     * 
+     * @param source The original image.
+     * @param transform The mapping from destination to source pixel coordinates.
+     * @param new_width The width of the warped image.
+     * @param new_height The height of the warped image.
+     * @return cimg_library::CImg<unsigned char> The warped image, black where the transform
+     * maps outside the source under the clamp edge mode.
+     */
+    cimg_library::CImg<unsigned char> warp(const cimg_library::CImg<unsigned char>& source, const affine_transform& transform, int new_width, int new_height) const;
 
 protected:
+    /**
+     * @brief Checks that a destination can receive the resized source and clips a region
+     * to the bounds of the source.
+     * 
+     * @param source The original image.
+     * @param region The requested region.
+     * @param destination The destination image.
+     * @return image_region The part of the region lying inside the source image.
+     * @throw std::invalid_argument If the region does not overlap the source image or the
+     * spectrums of the images differ.
+     */
+    static image_region clip_region(const const_image_view& source, const image_region& region, const image_view& destination) {
+        if (destination.spectrum != source.spectrum) {
+            throw std::invalid_argument("destination spectrum does not match the source image");
+        }
+        float x0 = std::max(region.x, 0.0f);
+        float y0 = std::max(region.y, 0.0f);
+        float x1 = std::min(region.x + region.width, static_cast<float>(source.width));
+        float y1 = std::min(region.y + region.height, static_cast<float>(source.height));
+        if (x1 <= x0 || y1 <= y0) {
+            throw std::invalid_argument("resize region does not overlap the source image");
+        }
+        return image_region{x0, y0, x1 - x0, y1 - y0};
+    }
+
+    /**
+     * @brief Returns the image a resize of a region samples.
+     * 
+     * This is the source itself, unless antialiasing is enabled and the resize shrinks the
+     * region by more than 2 on an axis. The pixels under the region are then blurred into
+     * the prefilter's buffer, and the region is moved to the coordinates of the blurred copy.
+     * 
+     * @param source The original image.
+     * @param region The clipped region, updated to the coordinates of the returned image.
+     * @param destination The destination image.
+     * @param prefilter The prefilter holding the blurred pixels.
+     * @return const_image_view The image to sample.
+     */
+    const_image_view prefiltered_source(const const_image_view& source, image_region& region, const image_view& destination, gaussian_prefilter& prefilter) const;
+
     /**
      * @brief Pure virtual method to estimate the color value at a specific position in the source image.
      * 
@@ -40,9 +278,33 @@ protected:
      * @param x The x-coordinate of the position.
      * @param y The y-coordinate of the position.
      * @param channel The color channel to estimate.
+     * @param edges How taps outside the source are taken.
      * @return unsigned char The estimated color value.
      */
-    virtual unsigned char estimate_color(const cimg_library::CImg<unsigned char>& source, float x, float y, int channel) const = 0;
+    virtual unsigned char estimate_color(const const_image_view& source, float x, float y, int channel, edge_mode edges) const = 0;
+
+    /**
+     * @brief Pure virtual method to warp the interior span of a destination row.
+     * 
+     * Every sample of the span reads only pixels inside the source, so derived classes
+     * sample it without any clamping or edge handling. The source coordinates are stepped
+     * by the transform's xx and yx from column to column and left past the end of the span.
+     * 
+     * @param source The original image.
+     * @param transform The mapping from destination to source pixel coordinates.
+     * @param src_x The x-coordinate sampled by the first column of the span.
+     * @param src_y The y-coordinate sampled by the first column of the span.
+     * @param x_begin The first column of the span.
+     * @param x_end The column past the end of the span.
+     * @param destination The image receiving the warped result.
+     * @param y The destination row.
+     */
+    virtual void warp_inside(const const_image_view& source, const affine_transform& transform, double& src_x, double& src_y, int x_begin, int x_end, const image_view& destination, int y) const = 0;
+
+private:
+    tile_options tiling_;
+    edge_mode edges_ = edge_mode::clamp;
+    bool antialiasing_ = false;
 };
 
 #endif // RESIZE_IMAGE_BASE_H
@@ -0,0 +1,216 @@
+#ifndef RESIZE_JOB_H
+#define RESIZE_JOB_H
+
+#include "resize_image_base.h"
+#include "resize_cache.h"
+#include "mapped_image.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Description of one resize request: which file to resize, how, and where to save it.
+ */
+
+struct resize_job {
+    std::string input;
+    std::string output;
+    std::string method = "bilinear";
+    int width = 0;      ///< Output width, 0 to derive it from the height or the scale factor
+    int height = 0;     ///< Output height, 0 to derive it from the width or the scale factor
+    float scale = 1.0f; ///< Scale factor used when neither width nor height is given
+    int quality = 90;   ///< JPEG output quality
+    bool keep_grey = false; ///< Saves colour inputs holding grey pixels with a single channel
+    bool antialias = false; ///< Prefilters large downscales, see resize_image_base::set_antialiasing
+    int tile_threads = 1;   ///< Threads resizing the tiles of the output, see resize_image_base::set_tiling
+};
+
+/**
+ * @brief Largest output width or height of a job, the largest a JPEG file can hold.
+ */
+const int max_job_dimension = 65535;
+
+/**
+ * @brief Largest number of tile threads of a job.
+ */
+const int max_tile_threads = 256;
+
+/**
+ * @brief Returns the shared resizer implementing the given method, with the default
+ * settings.
+ * 
+ * @param method The method name, "nearest", "bilinear", "box", "max", "min" or "mode".
+ * @return const resize_image_base& The resizer.
+ * @throw std::invalid_argument If the method is unknown.
+ */
+const resize_image_base& resizer_for(const std::string& method);
+
+/**
+ * @brief Creates a resizer implementing the given method, with its own settings.
+ * 
+ * @param method The method name, as for resizer_for.
+ * @param tiling The tiling options of the resizer.
+ * @return std::unique_ptr<resize_image_base> The resizer.
+ * @throw std::invalid_argument If the method is unknown.
+ */
+std::unique_ptr<resize_image_base> create_resizer(const std::string& method, const tile_options& tiling = tile_options());
+
+/**
+ * @brief Computes the output dimensions of a job for a given source size.
+ * 
+ * A missing width or height follows the aspect ratio of the source; if both are missing,
+ * the scale factor applies to both.
+ * 
+ * @param job The job.
+ * @param source_width The width of the source image, in display orientation.
+ * @param source_height The height of the source image, in display orientation.
+ * @return image_size The output dimensions.
+ * @throw std::invalid_argument If a dimension exceeds max_job_dimension.
+ */
+image_size job_output_size(const resize_job& job, int source_width, int source_height);
+
+/**
+ * @brief Checks the method and the numeric options of a job.
+ * 
+ * Jobs parsed from arguments and jobs received by the resize service go through the same
+ * checks: a known method, widths and heights between 0 and max_job_dimension, a finite
+ * positive scale factor, a quality between 1 and 100 and between 1 and max_tile_threads
+ * tile threads.
+ * 
+ * @param job The job.
+ * @throw std::invalid_argument If an option is out of range.
+ */
+void validate_job(const resize_job& job);
+
+/**
+ * @brief Applies command-line style options and positional paths to a job.
+ * 
+ * Recognised options are --method, --width, --height, --scale, --quality, --grey (expand
+ * or keep) and --tile-threads, each followed by its value, and the --antialias flag. The
+ * first two positional arguments are the input and output paths. The resulting job is checked with
+ * validate_job.
+ * 
+ * @param args The arguments to parse.
+ * @param job The job providing the defaults.
+ * @return resize_job The job with the arguments applied.
+ * @throw std::invalid_argument If an argument is unknown or malformed.
+ */
+resize_job parse_job_arguments(const std::vector<std::string>& args, resize_job job);
+
+/**
+ * @brief Reads a batch manifest, one job per line.
+ * 
+ * Each non-empty line not starting with '#' holds the arguments of one job, in the syntax
+ * of parse_job_arguments, applied on top of the given defaults.
+ * 
+ * @param path The path of the manifest file.
+ * @param defaults The job providing the defaults of every line.
+ * @return std::vector<resize_job> The jobs, in file order.
+ * @throw std::runtime_error If the manifest cannot be read.
+ * @throw std::invalid_argument If a line is malformed.
+ */
+std::vector<resize_job> read_manifest(const std::string& path, const resize_job& defaults);
+
+/**
+ * @brief Input image of a job, ready to be resized.
+ * 
+ * Uncompressed files (BMP, PGM, PPM) are mapped and resized in place, other formats are
+ * decoded with CImg.
+ */
+struct job_input {
+    mapped_image mapped;                        ///< The mapped file, if the format allows it
+    cimg_library::CImg<unsigned char> decoded;  ///< The decoded image otherwise
+    const_image_view pixels;                    ///< The pixels, in stored orientation
+    int orientation = 1;                        ///< The EXIF orientation of the image
+    bool grey = false;                          ///< Whether its red, green and blue channels are equal
+};
+
+/**
+ * @brief Opens the input image of a job, mapping it if possible and decoding it otherwise.
+ * 
+ * RGB images are checked for grey pixels with is_grey when their rows are planar, the
+ * layout the grey path of resize_job_into speeds up, or when the job keeps grey outputs
+ * with a single channel.
+ * 
+ * @param job The job.
+ * @return job_input The input image.
+ * @throw std::invalid_argument If the job has no input path.
+ * @throw std::runtime_error If the input cannot be mapped.
+ * @throw cimg_library::CImgException If the image cannot be decoded.
+ */
+job_input open_job_input(const resize_job& job);
+
+/**
+ * @brief Computes the output dimensions of a job for an opened input.
+ * 
+ * @param job The job.
+ * @param input The input image.
+ * @return image_size The output dimensions, in display orientation.
+ */
+image_size job_output_size(const resize_job& job, const job_input& input);
+
+/**
+ * @brief Returns the number of channels of the output of a job for an opened input: 1 for
+ * grey inputs of jobs keeping grey outputs, the spectrum of the input otherwise.
+ * 
+ * @param job The job.
+ * @param input The input image.
+ * @return int The output spectrum.
+ */
+int job_output_spectrum(const resize_job& job, const job_input& input);
+
+/**
+ * @brief Resizes an input image into a destination image, applying its EXIF orientation
+ * in the same pass.
+ * 
+ * The destination may be a view of memory owned by someone else, e.g. a buffer to be
+ * handed to another process. Grey inputs are resized from their first channel only, into
+ * a single-channel destination or into the first channel of the destination, which
+ * broadcast_grey then copies into the others. The job gets a resizer of its own from
+ * create_resizer, tiled with its tile threads.
+ * 
+ * @param job The job selecting the method and the tile threads.
+ * @param input The input image.
+ * @param destination The image receiving the result, sized with job_output_size and
+ * job_output_spectrum.
+ */
+void resize_job_into(const resize_job& job, const job_input& input, const image_view& destination);
+
+/**
+ * @brief Saves a resized image to the output path of a job, honouring its JPEG quality.
+ * 
+ * @param job The job.
+ * @param image The resized image.
+ * @throw cimg_library::CImgException If the image cannot be saved.
+ */
+void save_job_output(const resize_job& job, const cimg_library::CImg<unsigned char>& image);
+
+/**
+ * @brief Computes the key of the result of a job in a resize_cache.
+ * 
+ * The key combines a hash of the input file's bytes with the method, the requested size
+ * and the grey output and antialiasing options, so it can be computed without decoding
+ * the image.
+ * 
+ * @param job The job.
+ * @return std::string The key.
+ * @throw std::runtime_error If the input cannot be read.
+ */
+std::string job_cache_key(const resize_job& job);
+
+/**
+ * @brief Loads, resizes and saves the image described by a job.
+ * 
+ * The EXIF orientation of the input is applied during the resize. With a cache, a result
+ * computed before for the same input content and parameters is saved directly, without
+ * decoding or resizing anything.
+ * 
+ * @param job The job to run.
+ * @param cache The cache of resize results, or null.
+ * @return image_size The dimensions of the saved image.
+ * @throw std::invalid_argument If the job is incomplete or invalid.
+ * @throw cimg_library::CImgException If the image cannot be loaded or saved.
+ */
+image_size run_job(const resize_job& job, resize_cache* cache = nullptr);
+
+#endif // RESIZE_JOB_H
@@ -0,0 +1,204 @@
+#ifndef RESIZE_KERNELS_H
+#define RESIZE_KERNELS_H
+
+#include "image_view.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+/**
+ * @brief Per-sample interpolation kernels shared by the resizers.
+ * 
+ * They are defined inline here rather than behind the virtual estimate_color so that the
+ * resize loops can inline them.
+ */
+
+/**
+ * @brief How samples falling outside the source image are taken.
+ */
+enum class edge_mode {
+    clamp,   ///< Repeat the edge pixels; warps leave the destination untouched outside the source
+    mirror,  ///< Reflect the image about its edges
+    wrap     ///< Repeat the whole image
+};
+
+namespace resize_kernels {
+
+/**
+ * @brief Maps a pixel index of an axis, possibly outside of it, to the index sampled.
+ */
+inline int resolve_edge(int index, int size, edge_mode edges) {
+    switch (edges) {
+    case edge_mode::mirror: {
+        int period = 2 * size;
+        index %= period;
+        if (index < 0) {
+            index += period;
+        }
+        return index < size ? index : period - 1 - index;
+    }
+    case edge_mode::wrap:
+        index %= size;
+        return index < 0 ? index + size : index;
+    default:
+        return std::max(0, std::min(index, size - 1));
+    }
+}
+
+/**
+ * @brief Linear interpolation between two values.
+ */
+inline float interpolate(float start, float end, float factor) {
+    return start + factor * (end - start);
+}
+
+/**
+ * @brief Samples a channel at a position with nearest neighbour interpolation, applying
+ * the edge mode to positions outside the source.
+ */
+inline unsigned char nearest_sample(const const_image_view& source, float x, float y, int channel, edge_mode edges = edge_mode::clamp) {
+    int nearest_x = resize_kernels::resolve_edge(static_cast<int>(std::round(x)), source.width, edges);
+    int nearest_y = resize_kernels::resolve_edge(static_cast<int>(std::round(y)), source.height, edges);
+    return source(nearest_x, nearest_y, channel);
+}
+
+/**
+ * @brief Samples a channel at a position with bilinear interpolation, applying the edge
+ * mode to the taps outside the source.
+ */
+inline unsigned char bilinear_sample(const const_image_view& source, float x, float y, int channel, edge_mode edges = edge_mode::clamp) {
+    float x_floor = std::floor(x);
+    float y_floor = std::floor(y);
+    int x1 = resize_kernels::resolve_edge(static_cast<int>(x_floor), source.width, edges);
+    int y1 = resize_kernels::resolve_edge(static_cast<int>(y_floor), source.height, edges);
+    int x2 = resize_kernels::resolve_edge(static_cast<int>(x_floor) + 1, source.width, edges);
+    int y2 = resize_kernels::resolve_edge(static_cast<int>(y_floor) + 1, source.height, edges);
+
+    float x_frac = x - x_floor;
+    float y_frac = y - y_floor;
+
+    float top = interpolate(source(x1, y1, channel), source(x2, y1, channel), x_frac);
+    float bottom = interpolate(source(x1, y2, channel), source(x2, y2, channel), x_frac);
+
+    return static_cast<unsigned char>(interpolate(top, bottom, y_frac));
+}
+
+/**
+ * @brief Samples a channel with nearest neighbour interpolation at a position whose
+ * nearest pixel is known to lie inside the source, so without any edge handling.
+ */
+inline unsigned char nearest_sample_inside(const const_image_view& source, float x, float y, int channel) {
+    return source(static_cast<int>(std::round(x)), static_cast<int>(std::round(y)), channel);
+}
+
+/**
+ * @brief Samples a channel with bilinear interpolation at a position whose four taps are
+ * known to lie inside the source, so without any edge handling.
+ */
+inline unsigned char bilinear_sample_inside(const const_image_view& source, float x, float y, int channel) {
+    int x1 = static_cast<int>(x);
+    int y1 = static_cast<int>(y);
+    float x_frac = x - x1;
+    float y_frac = y - y1;
+
+    float top = interpolate(source(x1, y1, channel), source(x1 + 1, y1, channel), x_frac);
+    float bottom = interpolate(source(x1, y1 + 1, channel), source(x1 + 1, y1 + 1, channel), x_frac);
+
+    return static_cast<unsigned char>(interpolate(top, bottom, y_frac));
+}
+
+/**
+ * @brief Coefficient table of the samples taken along one axis of a resize.
+ * 
+ * It is computed once per resize and shared by every tile and row, so the per-pixel loops
+ * only look up indices and weights. Entry i describes the sample of destination index i:
+ * the two source indices it interpolates between and the weight of the second one.
+ * Nearest neighbour tables only fill first.
+ */
+struct axis_table {
+    std::vector<int> first;
+    std::vector<int> second;
+    std::vector<float> fraction;
+};
+
+/**
+ * @brief Builds the table of bilinear samples start + i * ratio, capped at last, for a
+ * source axis of the given size; the indices and weights are those of bilinear_sample.
+ */
+inline axis_table bilinear_axis(float start, float ratio, float last, int count, int size) {
+    axis_table table;
+    table.first.resize(count);
+    table.second.resize(count);
+    table.fraction.resize(count);
+    for (int i = 0; i < count; ++i) {
+        float position = std::min(start + i * ratio, last);
+        int index = static_cast<int>(position);
+        table.first[i] = index;
+        table.second[i] = std::min(index + 1, size - 1);
+        table.fraction[i] = position - index;
+    }
+    return table;
+}
+
+/**
+ * @brief Builds the table of nearest neighbour samples start + i * ratio, capped at last,
+ * for a source axis of the given size; the indices are those of nearest_sample.
+ */
+inline axis_table nearest_axis(float start, float ratio, float last, int count, int size) {
+    axis_table table;
+    table.first.resize(count);
+    for (int i = 0; i < count; ++i) {
+        int index = static_cast<int>(std::round(std::min(start + i * ratio, last)));
+        table.first[i] = std::max(0, std::min(index, size - 1));
+    }
+    return table;
+}
+
+/**
+ * @brief Rounds the footprint of destination index i along one axis to source pixels, as
+ * the box and reduction filters average or reduce them.
+ * 
+ * The edges start + i * ratio and start + (i + 1) * ratio are rounded to the nearest pixel
+ * within [first, last_end); footprints narrower than a pixel keep the pixel their left
+ * edge rounds to.
+ * 
+ * @param start The source coordinate of the left edge of the first footprint.
+ * @param ratio The width of a footprint, in source pixels.
+ * @param first The first source pixel the footprints may cover.
+ * @param last_end The source pixel past the last one the footprints may cover.
+ * @param i The destination index.
+ * @param begin Receives the first source pixel of the footprint.
+ * @param end Receives the source pixel past its last one.
+ */
+inline void footprint_edges(float start, float ratio, int first, int last_end, int i, int& begin, int& end) {
+    begin = static_cast<int>(std::lround(start + i * ratio));
+    end = static_cast<int>(std::lround(start + (i + 1) * ratio));
+    begin = std::min(std::max(begin, first), last_end - 1);
+    end = std::max(std::min(end, last_end), begin + 1);
+}
+
+/**
+ * @brief Table of the footprints of count destination pixels along one axis: entry i
+ * covers the source pixels [begin[i], end[i]), as given by footprint_edges.
+ */
+struct footprint_table {
+    std::vector<int> begin;
+    std::vector<int> end;
+};
+
+/**
+ * @brief Builds the footprint table of count destination pixels along one axis.
+ */
+inline footprint_table footprint_axis(float start, float ratio, int first, int last_end, int count) {
+    footprint_table table;
+    table.begin.resize(count);
+    table.end.resize(count);
+    for (int i = 0; i < count; ++i) {
+        footprint_edges(start, ratio, first, last_end, i, table.begin[i], table.end[i]);
+    }
+    return table;
+}
+
+} // namespace resize_kernels
+
+#endif // RESIZE_KERNELS_H
@@ -14,14 +14,27 @@
 class resize_nearest_neighbour : public resize_image_base {
 public:
     /**
-     * @brief Resizes the given source image to the specified new dimensions using nearest neighbour interpolation.
+     * @brief Resizes a region of the source image directly into the destination image.
+     * 
+     * @param source The original image.
+     * @param region The rectangle of the source image to resize.
+     * @param destination The image receiving the resized region.
+     */
+    void resize_region(const const_image_view& source, const image_region& region, const image_view& destination) const override;
+    using resize_image_base::resize_region;
+
+    /**
+     * @brief Resizes an image to several sizes in a single pass over the source rows.
+     * 
+     * Each source row is read once, while every size writes the destination rows sampling
+     * it with its own tables and row kernels, so the results are those of resize(). With
+     * antialiasing or several tile threads, each size is resized on its own instead.
      * 
      * @param source The original image to be resized.
-     * @param new_width The desired width of the resized image.
-     * @param new_height The desired height of the resized image.
-     * @return cimg_library::CImg<unsigned char> The resized image.
+     * @param destinations The images receiving the resized images.
      */
-    cimg_library::CImg<unsigned char> resize(const cimg_library::CImg<unsigned char>& source, int new_width, int new_height) const override;
+    void resize_many(const const_image_view& source, const std::vector<image_view>& destinations) const override;
+    using resize_image_base::resize_many;
 
 protected:
     /**
@@ -31,9 +44,24 @@ protected:
      * @param x The x-coordinate of the position.
      * @param y The y-coordinate of the position.
      * @param channel The color channel to estimate.
+     * @param edges How taps outside the source are taken.
      * @return unsigned char The estimated color value.
      */
-    unsigned char estimate_color(const cimg_library::CImg<unsigned char>& source, float x, float y, int channel) const override;
+    unsigned char estimate_color(const const_image_view& source, float x, float y, int channel, edge_mode edges) const override;
+
+    /**
+     * @brief Warps the interior span of a destination row with nearest neighbour interpolation, without any edge handling.
+     * 
+     * @param source The original image.
+     * @param transform The mapping from destination to source pixel coordinates.
+     * @param src_x The x-coordinate sampled by the first column of the span.
+     * @param src_y The y-coordinate sampled by the first column of the span.
+     * @param x_begin The first column of the span.
+     * @param x_end The column past the end of the span.
+     * @param destination The image receiving the warped result.
+     * @param y The destination row.
+     */
+    void warp_inside(const const_image_view& source, const affine_transform& transform, double& src_x, double& src_y, int x_begin, int x_end, const image_view& destination, int y) const override;
 };
 
 #endif // RESIZE_NEAREST_NEIGHBOUR_H
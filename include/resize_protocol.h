@@ -0,0 +1,114 @@
+#ifndef RESIZE_PROTOCOL_H
+#define RESIZE_PROTOCOL_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Framed binary protocol spoken over the resize service's Unix domain socket.
+ * 
+ * Every message is a frame_header followed by length bytes of payload, in host byte order
+ * since both ends run on the same machine. A frame may carry one file descriptor as
+ * SCM_RIGHTS ancillary data, which is how pixel buffers travel without being copied; any
+ * further descriptor is closed on receipt.
+ * 
+ * A resize_file request holds, in order: width, height (int32, 0 to derive them), scale
+ * (float32), quality (int32), keep_grey (int32, nonzero to keep RGB inputs holding grey
+ * pixels single-channel), antialias (int32, nonzero to prefilter large downscales), then
+ * method, input path and output path (strings, each a uint32 length followed by the bytes). When the output path is empty, the resized pixels
+ * are not saved but returned in a memfd attached to the reply, laid out as planar
+ * CImg<unsigned char> data of width * height * spectrum bytes.
+ * 
+ * A resize_shared request carries the source pixels as an attached memfd sealed against
+ * shrinking, as shared_image::create makes them, in the same planar layout, and holds:
+ * method (string), width and height of the result, then width, height and spectrum of the
+ * source (int32). The result always comes back as a memfd.
+ * 
+ * A reply holds status (int32, 0 on success), width, height and spectrum (int32) of the
+ * result, then an error message (string, empty on success).
+ */
+
+namespace resize_protocol {
+
+const std::uint32_t frame_magic = 0x315a5352; // "RSZ1"
+const std::uint32_t max_payload_length = 1 << 20;
+
+enum message_type : std::uint16_t {
+    resize_file = 1,
+    resize_shared = 2,
+    reply = 100
+};
+
+struct frame_header {
+    std::uint32_t magic;
+    std::uint16_t type;
+    std::uint16_t reserved;
+    std::uint32_t length;
+};
+
+/**
+ * @brief A received message: its type, payload and the file descriptor attached to it.
+ */
+struct frame {
+    std::uint16_t type = 0;
+    std::vector<unsigned char> payload;
+    int fd = -1; ///< Attached file descriptor owned by the receiver, or -1
+};
+
+/**
+ * @brief Serialises the fields of a payload.
+ */
+class payload_writer {
+public:
+    void put_int(std::int32_t value);
+    void put_float(float value);
+    void put_string(const std::string& value);
+    const std::vector<unsigned char>& data() const { return data_; }
+
+private:
+    void put_bytes(const void* bytes, std::size_t size);
+    std::vector<unsigned char> data_;
+};
+
+/**
+ * @brief Reads back the fields of a payload, in the order they were written.
+ * 
+ * @throw std::runtime_error From every getter when the payload is too short.
+ */
+class payload_reader {
+public:
+    explicit payload_reader(const std::vector<unsigned char>& data) : data_(data), offset_(0) {}
+    std::int32_t get_int();
+    float get_float();
+    std::string get_string();
+
+private:
+    void get_bytes(void* bytes, std::size_t size);
+    const std::vector<unsigned char>& data_;
+    std::size_t offset_;
+};
+
+/**
+ * @brief Sends a frame, optionally attaching a file descriptor.
+ * 
+ * @param socket The connected socket.
+ * @param type The message type.
+ * @param payload The payload.
+ * @param fd The file descriptor to pass, or -1. The caller keeps ownership of it.
+ * @return bool False if the connection failed.
+ */
+bool send_frame(int socket, std::uint16_t type, const std::vector<unsigned char>& payload, int fd = -1);
+
+/**
+ * @brief Receives a frame along with any file descriptor attached to it.
+ * 
+ * @param socket The connected socket.
+ * @param message Receives the frame.
+ * @return bool False if the peer closed the connection or sent a malformed frame.
+ */
+bool receive_frame(int socket, frame& message);
+
+} // namespace resize_protocol
+
+#endif // RESIZE_PROTOCOL_H
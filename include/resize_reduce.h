@@ -0,0 +1,71 @@
+#ifndef RESIZE_REDUCE_H
+#define RESIZE_REDUCE_H
+
+#include "resize_nearest_neighbour.h"
+
+/**
+ * @brief Reductions applied by resize_reduce to the source pixels under a destination pixel.
+ */
+enum class reduction {
+    max,    ///< The largest value, which keeps thin foreground structures and near obstacles
+    min,    ///< The smallest value, e.g. the nearest point of a depth map
+    mode    ///< The most frequent value, the smallest one on ties, for label masks
+};
+
+/**
+ * @brief Class for downscaling depth maps and label masks by block reductions.
+ * 
+ * Each destination pixel reduces the source pixels between the rounded edges of its
+ * footprint, the blocks of resize_box given by resize_kernels::footprint_edges, to a
+ * value they already hold, so no new class identifiers or depths are invented as
+ * interpolation would. Upscales repeat the single pixel under each destination pixel.
+ * Channels are reduced independently, so masks are expected to hold one label per pixel
+ * in a single channel.
+ * 
+ * Destination rows are produced in order. For max and min, the source rows of a block are
+ * folded into a row buffer with element-wise operations the compiler vectorises, then each
+ * block of the buffer is reduced. For mode, every block is counted into a 256-bin histogram
+ * whose leader is tracked as it grows. Warps sample the nearest pixel, as by
+ * resize_nearest_neighbour.
+ */
+
+class resize_reduce : public resize_nearest_neighbour {
+public:
+    /**
+     * @brief Creates a resizer applying the given reduction.
+     * 
+     * @param kind The reduction.
+     */
+    explicit resize_reduce(reduction kind) : kind_(kind) {}
+
+    /**
+     * @brief Returns the reduction applied by the resizer.
+     */
+    reduction kind() const {
+        return kind_;
+    }
+
+    /**
+     * @brief Reduces a region of the source image directly into the destination image.
+     * 
+     * @param source The original image.
+     * @param region The rectangle of the source image to resize.
+     * @param destination The image receiving the resized region.
+     */
+    void resize_region(const const_image_view& source, const image_region& region, const image_view& destination) const override;
+    using resize_image_base::resize_region;
+
+    /**
+     * @brief Reduces an image to several sizes, one size at a time.
+     * 
+     * @param source The original image to be resized.
+     * @param destinations The images receiving the resized images.
+     */
+    void resize_many(const const_image_view& source, const std::vector<image_view>& destinations) const override;
+    using resize_image_base::resize_many;
+
+private:
+    reduction kind_;
+};
+
+#endif // RESIZE_REDUCE_H
@@ -0,0 +1,73 @@
+#ifndef RESIZE_SERVER_H
+#define RESIZE_SERVER_H
+
+#include "resize_protocol.h"
+#include "resize_cache.h"
+#include <atomic>
+#include <string>
+
+/**
+ * @brief Long-running resize service listening on a Unix domain socket.
+ * 
+ * Keeping the process alive saves the start-up cost (dynamic linking, CImg initialisation,
+ * thread creation) that dominates short resize jobs. A fixed pool of worker threads accepts
+ * connections and serves the frames of the resize_protocol sent over them until the client
+ * disconnects.
+ */
+
+class resize_server {
+public:
+    /**
+     * @brief Largest number of pixels of a result the service produces, 8192 x 8192; larger
+     * requests are answered with an error instead of allocating their result.
+     */
+    static constexpr long long max_output_pixels = 8192LL * 8192;
+
+    /**
+     * @brief Binds the server to its socket.
+     * 
+     * A stale socket file left at the path is replaced.
+     * 
+     * @param socket_path The filesystem path of the Unix domain socket.
+     * @param thread_count The number of connections served concurrently.
+     * @param cache The cache of resize results shared by all connections, or null.
+     * @param tile_threads The number of threads resizing the tiles of each result, as the
+     * tile_threads of a resize_job.
+     * @throw std::runtime_error If the socket cannot be created.
+     */
+    resize_server(const std::string& socket_path, int thread_count, resize_cache* cache, int tile_threads = 1);
+
+    /**
+     * @brief Closes the socket and removes its file.
+     */
+    ~resize_server();
+
+    resize_server(const resize_server&) = delete;
+    resize_server& operator=(const resize_server&) = delete;
+
+    /**
+     * @brief Serves connections until stop() is called.
+     */
+    void run();
+
+    /**
+     * @brief Makes run() return once the connections being served are done.
+     * 
+     * This only shuts the listening socket down, so it is safe to call from a signal handler.
+     */
+    void stop();
+
+private:
+    void serve_connection(int connection) const;
+    resize_protocol::frame handle_resize_file(const resize_protocol::frame& request) const;
+    resize_protocol::frame handle_resize_shared(resize_protocol::frame& request) const;
+
+    std::string socket_path_;
+    int thread_count_;
+    resize_cache* cache_;
+    int tile_threads_;
+    int listener_;
+    std::atomic<bool> running_;
+};
+
+#endif // RESIZE_SERVER_H
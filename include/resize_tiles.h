@@ -0,0 +1,64 @@
+#ifndef RESIZE_TILES_H
+#define RESIZE_TILES_H
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+/**
+ * @brief How a resize is split into tiles of the destination image.
+ */
+struct tile_options {
+    /**
+     * @brief Bytes of source and destination pixels a tile may touch; 0 uses half of the
+     * L2 cache reported by the system.
+     */
+    std::size_t cache_bytes = 0;
+
+    /**
+     * @brief Number of threads processing tiles in parallel.
+     */
+    int thread_count = 1;
+};
+
+/**
+ * @brief Rectangle of destination pixels processed as a unit.
+ */
+struct image_tile {
+    int x;
+    int y;
+    int width;
+    int height;
+};
+
+/**
+ * @brief Splits a destination image into tiles whose working set fits in the cache.
+ * 
+ * The working set of a tile is its destination pixels plus the source pixels they sample,
+ * including the halo of one extra source row and column an interpolation kernel reaches.
+ * Tiles span the full width whenever a band of rows fits, since rows are the contiguous
+ * direction of every layout; very wide images are cut into columns as well.
+ * 
+ * @param width The width of the destination image.
+ * @param height The height of the destination image.
+ * @param spectrum The number of channels.
+ * @param x_ratio The source columns per destination column.
+ * @param y_ratio The source rows per destination row.
+ * @param options The tiling options.
+ * @return std::vector<image_tile> The tiles, covering the destination image in row-major order.
+ */
+std::vector<image_tile> plan_tiles(int width, int height, int spectrum, float x_ratio, float y_ratio, const tile_options& options);
+
+/**
+ * @brief Processes tiles, on several threads if requested.
+ * 
+ * Threads take the next unprocessed tile in turn, so neighbouring tiles, which share
+ * source rows at their borders, tend to be processed at the same time.
+ * 
+ * @param tiles The tiles to process.
+ * @param thread_count The number of threads, including the calling one.
+ * @param process The function processing one tile; it must not throw.
+ */
+void for_each_tile(const std::vector<image_tile>& tiles, int thread_count, const std::function<void(const image_tile&)>& process);
+
+#endif // RESIZE_TILES_H
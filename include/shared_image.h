@@ -0,0 +1,85 @@
+#ifndef SHARED_IMAGE_H
+#define SHARED_IMAGE_H
+
+#include "CImg.h"
+
+/**
+ * @brief Planar 8-bit image stored in anonymous shared memory (a memfd).
+ * 
+ * The file descriptor can be passed to another process, which maps the same pixels, so
+ * images travel between the resize service and its clients without being copied or
+ * encoded. The pixels are laid out like those of a CImg<unsigned char> of depth 1. The
+ * memfd is sealed against shrinking and growing, so that a peer cannot truncate it under
+ * a mapping, which would fault on the next access.
+ */
+
+class shared_image {
+public:
+    /**
+     * @brief Creates an empty image that owns no memory.
+     */
+    shared_image();
+
+    /**
+     * @brief Allocates a zero-filled image in a new, sealed memfd.
+     * 
+     * @param width The image width.
+     * @param height The image height.
+     * @param spectrum The number of channels.
+     * @return shared_image The image.
+     * @throw std::invalid_argument If a dimension is not positive.
+     * @throw std::runtime_error If the shared memory cannot be allocated.
+     */
+    static shared_image create(int width, int height, int spectrum);
+
+    /**
+     * @brief Maps an image received as a file descriptor, taking ownership of the descriptor.
+     * 
+     * @param fd The memfd holding the pixels, sealed against shrinking.
+     * @param width The image width.
+     * @param height The image height.
+     * @param spectrum The number of channels.
+     * @param writable Whether the mapping may be written to.
+     * @return shared_image The image.
+     * @throw std::invalid_argument If the descriptor is not sealed against shrinking or is too
+     * small for the given dimensions.
+     * @throw std::runtime_error If the descriptor cannot be mapped.
+     */
+    static shared_image adopt(int fd, int width, int height, int spectrum, bool writable);
+
+    ~shared_image();
+    shared_image(shared_image&& other) noexcept;
+    shared_image& operator=(shared_image&& other) noexcept;
+    shared_image(const shared_image&) = delete;
+    shared_image& operator=(const shared_image&) = delete;
+
+    /**
+     * @brief Returns a non-owning CImg over the shared pixels.
+     * 
+     * Writing to the view writes to the shared memory, which is only allowed if the image was
+     * mapped writable. The view must not outlive this object.
+     * 
+     * @return cimg_library::CImg<unsigned char> A CImg with is_shared set.
+     */
+    cimg_library::CImg<unsigned char> view() const;
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+    int spectrum() const { return spectrum_; }
+    int fd() const { return fd_; }
+    unsigned char* data() const { return data_; }
+    std::size_t size() const { return static_cast<std::size_t>(width_) * height_ * spectrum_; }
+    bool empty() const { return data_ == nullptr; }
+
+private:
+    shared_image(int fd, unsigned char* data, int width, int height, int spectrum);
+    void release();
+
+    int fd_;
+    unsigned char* data_;
+    int width_;
+    int height_;
+    int spectrum_;
+};
+
+#endif // SHARED_IMAGE_H
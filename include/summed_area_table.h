@@ -0,0 +1,96 @@
+#ifndef SUMMED_AREA_TABLE_H
+#define SUMMED_AREA_TABLE_H
+
+#include "image_view.h"
+#include "resize_image_base.h"
+#include "resize_tiles.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Summed-area table of an image, from which the sum of any box of pixels takes
+ * four lookups.
+ * 
+ * Entry (x, y) of a channel holds the sum of the pixels above and to the left of (x, y),
+ * so each channel table has one more row and column than the image. The sums are 32-bit
+ * and wrap around. The difference of four entries is still the exact sum of a box when
+ * that sum fits in 32 bits, which holds for boxes of up to max_box_area pixels whatever
+ * the size of the image.
+ * 
+ * Once built, box-filtered resizes to any number of sizes only cost their output pixels.
+ */
+class summed_area_table {
+public:
+    /**
+     * @brief Largest box whose sum of 8-bit pixels, plus half its area for rounding the
+     * mean, always fits in 32 bits.
+     */
+    static constexpr std::uint32_t max_box_area = 0xffffffffu / 256;
+
+    /**
+     * @brief Builds the tables of every channel of an image.
+     * 
+     * @param source The image to sum.
+     */
+    explicit summed_area_table(const const_image_view& source);
+
+    int width() const {
+        return width_;
+    }
+
+    int height() const {
+        return height_;
+    }
+
+    int spectrum() const {
+        return spectrum_;
+    }
+
+    /**
+     * @brief Returns the sum of a channel over the box of pixels [x0, x1) x [y0, y1).
+     */
+    std::uint32_t box_sum(int x0, int y0, int x1, int y1, int channel) const {
+        const std::uint32_t* top = entry(y0, channel);
+        const std::uint32_t* bottom = entry(y1, channel);
+        return bottom[x1] - bottom[x0] - top[x1] + top[x0];
+    }
+
+    /**
+     * @brief Box filters a region of the image into the destination image.
+     * 
+     * Each destination pixel is the rounded mean of the source pixels between the edges of
+     * its footprint in the region, rounded by resize_kernels::footprint_edges, or of the
+     * single pixel under it when upscaling.
+     * 
+     * @param region The rectangle of the image to resize.
+     * @param destination The image receiving the resized region.
+     * @param tiling How the destination is split into tiles and how many threads fill them.
+     * @throw std::invalid_argument If the region does not overlap the image, the spectrums
+     * differ or a box holds more than max_box_area pixels.
+     */
+    void resize_region(const image_region& region, const image_view& destination, const tile_options& tiling = tile_options()) const;
+
+    /**
+     * @brief Box filters the whole image into the destination image.
+     * 
+     * @param destination The image receiving the resized image.
+     * @param tiling How the destination is split into tiles and how many threads fill them.
+     */
+    void resize(const image_view& destination, const tile_options& tiling = tile_options()) const {
+        resize_region(image_region{0.0f, 0.0f, static_cast<float>(width_), static_cast<float>(height_)}, destination, tiling);
+    }
+
+private:
+    // Row y of the table of a channel
+    const std::uint32_t* entry(int y, int channel) const {
+        return &sums_[(static_cast<std::size_t>(channel) * (height_ + 1) + y) * (width_ + 1)];
+    }
+
+    int width_;
+    int height_;
+    int spectrum_;
+    std::vector<std::uint32_t> sums_;
+};
+
+#endif // SUMMED_AREA_TABLE_H
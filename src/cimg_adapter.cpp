@@ -0,0 +1,65 @@
+#include "cimg_adapter.h"
+#include "resize_image_base.h"
+#include "pixel_layout.h"
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+using namespace cimg_library;
+
+cimg_library::CImg<unsigned char> resize_image_base::resize(const cimg_library::CImg<unsigned char>& source, int new_width, int new_height) const {
+    cimg_library::CImg<unsigned char> result(new_width, new_height, 1, source.spectrum(), 0);
+    resize(view_of(source), view_of(result));
+    return result;
+}
+
+void resize_image_base::resize_region(const cimg_library::CImg<unsigned char>& source, const image_region& region, cimg_library::CImg<unsigned char>& destination) const {
+    resize_region(view_of(source), region, view_of(destination));
+}
+
+cimg_library::CImg<unsigned char> resize_image_base::resize_region(const cimg_library::CImg<unsigned char>& source, const image_region& region, int new_width, int new_height) const {
+    cimg_library::CImg<unsigned char> result(new_width, new_height, 1, source.spectrum(), 0);
+    resize_region(view_of(source), region, view_of(result));
+    return result;
+}
+
+std::vector<cimg_library::CImg<unsigned char>> resize_image_base::resize_many(const cimg_library::CImg<unsigned char>& source, const std::vector<image_size>& sizes) const {
+    std::vector<cimg_library::CImg<unsigned char>> results;
+    std::vector<image_view> destinations;
+    results.reserve(sizes.size());
+    for (const image_size& size : sizes) {
+        results.emplace_back(size.width, size.height, 1, source.spectrum(), 0);
+        destinations.push_back(view_of(results.back()));
+    }
+    resize_many(view_of(source), destinations);
+    return results;
+}
+
+void resize_image_base::warp(const cimg_library::CImg<unsigned char>& source, const affine_transform& transform, cimg_library::CImg<unsigned char>& destination) const {
+    warp(view_of(source), transform, view_of(destination));
+}
+
+cimg_library::CImg<unsigned char> resize_image_base::warp(const cimg_library::CImg<unsigned char>& source, const affine_transform& transform, int new_width, int new_height) const {
+    cimg_library::CImg<unsigned char> result(new_width, new_height, 1, source.spectrum(), 0);
+    warp(view_of(source), transform, view_of(result));
+    return result;
+}
+
+void save_pnm(const cimg_library::CImg<unsigned char>& image, const std::string& path) {
+    if (image.spectrum() != 1 && image.spectrum() != 3) {
+        throw std::invalid_argument("PNM files hold one or three channels");
+    }
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << 'P' << (image.spectrum() == 1 ? '5' : '6') << '\n' << image.width() << ' ' << image.height() << "\n255\n";
+
+    // Rows are interleaved one at a time into a buffer that stays in the cache
+    std::vector<unsigned char> row(static_cast<std::size_t>(image.width()) * image.spectrum());
+    const_image_view pixels = view_of(image);
+    for (int y = 0; y < image.height() && file; ++y) {
+        interleave_pixels(pixels.row(y, 0), pixels.channel_stride, image.width(), image.spectrum(), row.data());
+        file.write(reinterpret_cast<const char*>(row.data()), row.size());
+    }
+    if (!file.flush()) {
+        throw std::runtime_error("cannot write " + path);
+    }
+}
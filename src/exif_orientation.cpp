@@ -0,0 +1,188 @@
+#include "exif_orientation.h"
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <vector>
+
+namespace {
+
+const std::uint16_t orientation_tag = 0x0112;
+const std::uint16_t short_type = 3;
+
+// Reader for the TIFF structure embedded in an EXIF block, honouring its byte order
+class tiff_reader {
+public:
+    tiff_reader(const unsigned char* data, std::size_t size) : data_(data), size_(size), big_endian_(false) {}
+
+    bool read_header(std::uint32_t& first_ifd) {
+        if (size_ < 8) {
+            return false;
+        }
+        if (data_[0] == 'M' && data_[1] == 'M') {
+            big_endian_ = true;
+        } else if (!(data_[0] == 'I' && data_[1] == 'I')) {
+            return false;
+        }
+        std::uint16_t magic;
+        return read16(2, magic) && magic == 42 && read32(4, first_ifd);
+    }
+
+    bool read16(std::size_t offset, std::uint16_t& value) const {
+        if (offset + 2 > size_) {
+            return false;
+        }
+        value = big_endian_ ? (data_[offset] << 8) | data_[offset + 1] : data_[offset] | (data_[offset + 1] << 8);
+        return true;
+    }
+
+    bool read32(std::size_t offset, std::uint32_t& value) const {
+        std::uint16_t first, second;
+        if (!read16(offset, first) || !read16(offset + 2, second)) {
+            return false;
+        }
+        value = big_endian_ ? (std::uint32_t(first) << 16) | second : (std::uint32_t(second) << 16) | first;
+        return true;
+    }
+
+private:
+    const unsigned char* data_;
+    std::size_t size_;
+    bool big_endian_;
+};
+
+int parse_exif_orientation(const std::vector<unsigned char>& tiff) {
+    tiff_reader reader(tiff.data(), tiff.size());
+    std::uint32_t ifd;
+    std::uint16_t entries;
+    if (!reader.read_header(ifd) || !reader.read16(ifd, entries)) {
+        return 1;
+    }
+    for (std::uint16_t i = 0; i < entries; ++i) {
+        std::size_t entry = ifd + 2 + std::size_t(i) * 12;
+        std::uint16_t tag, type, value;
+        if (!reader.read16(entry, tag) || !reader.read16(entry + 2, type)) {
+            return 1;
+        }
+        if (tag == orientation_tag) {
+            if (type != short_type || !reader.read16(entry + 8, value) || value < 1 || value > 8) {
+                return 1;
+            }
+            return value;
+        }
+    }
+    return 1;
+}
+
+} // namespace
+
+int read_exif_orientation(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    unsigned char soi[2];
+    if (!file.read(reinterpret_cast<char*>(soi), 2) || soi[0] != 0xFF || soi[1] != 0xD8) {
+        return 1;
+    }
+
+    // Walk the marker segments up to the start of the compressed data
+    while (true) {
+        int byte = file.get();
+        if (byte != 0xFF) {
+            return 1;
+        }
+        int marker;
+        do {
+            marker = file.get();
+        } while (marker == 0xFF);
+        if (marker == EOF || marker == 0xDA || marker == 0xD9) {
+            return 1;
+        }
+        if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) {
+            continue;
+        }
+
+        unsigned char length_bytes[2];
+        if (!file.read(reinterpret_cast<char*>(length_bytes), 2)) {
+            return 1;
+        }
+        int length = (length_bytes[0] << 8) | length_bytes[1];
+        if (length < 2) {
+            return 1;
+        }
+        if (marker != 0xE1) {
+            file.seekg(length - 2, std::ios::cur);
+            continue;
+        }
+
+        std::vector<unsigned char> payload(length - 2);
+        if (!file.read(reinterpret_cast<char*>(payload.data()), payload.size())) {
+            return 1;
+        }
+        static const unsigned char exif_header[6] = {'E', 'x', 'i', 'f', 0, 0};
+        if (payload.size() >= 6 && std::equal(exif_header, exif_header + 6, payload.begin())) {
+            return parse_exif_orientation(std::vector<unsigned char>(payload.begin() + 6, payload.end()));
+        }
+    }
+}
+
+bool orientation_swaps_axes(int orientation) {
+    return orientation >= 5 && orientation <= 8;
+}
+
+affine_transform orientation_transform(int orientation, int source_width, int source_height, int new_width, int new_height) {
+    bool swap = orientation_swaps_axes(orientation);
+    double x_ratio = static_cast<double>(source_width) / (swap ? new_height : new_width);
+    double y_ratio = static_cast<double>(source_height) / (swap ? new_width : new_height);
+
+    // A reversed axis samples at ratio * (last - d) instead of ratio * d, which matches
+    // resizing first and then flipping the result
+    double last_x = new_width - 1;
+    double last_y = new_height - 1;
+    switch (orientation) {
+    case 2: // mirrored horizontally
+        return affine_transform{-x_ratio, 0.0, last_x * x_ratio, 0.0, y_ratio, 0.0};
+    case 3: // rotated 180
+        return affine_transform{-x_ratio, 0.0, last_x * x_ratio, 0.0, -y_ratio, last_y * y_ratio};
+    case 4: // mirrored vertically
+        return affine_transform{x_ratio, 0.0, 0.0, 0.0, -y_ratio, last_y * y_ratio};
+    case 5: // transposed
+        return affine_transform{0.0, x_ratio, 0.0, y_ratio, 0.0, 0.0};
+    case 6: // needs a 90 degree clockwise rotation
+        return affine_transform{0.0, x_ratio, 0.0, -y_ratio, 0.0, last_x * y_ratio};
+    case 7: // transversed
+        return affine_transform{0.0, -x_ratio, last_y * x_ratio, -y_ratio, 0.0, last_x * y_ratio};
+    case 8: // needs a 90 degree counter-clockwise rotation
+        return affine_transform{0.0, -x_ratio, last_y * x_ratio, y_ratio, 0.0, 0.0};
+    default:
+        return affine_transform::scale(x_ratio, y_ratio);
+    }
+}
+
+image_view oriented_view(const image_view& displayed, int orientation) {
+    // Offsets of the last column and row, where reversed axes start
+    std::ptrdiff_t last_x = (displayed.width - 1) * displayed.x_stride;
+    std::ptrdiff_t last_y = (displayed.height - 1) * displayed.row_stride;
+    int width = displayed.width;
+    int height = displayed.height;
+    int spectrum = displayed.spectrum;
+    std::ptrdiff_t x_stride = displayed.x_stride;
+    std::ptrdiff_t row_stride = displayed.row_stride;
+    std::ptrdiff_t channel_stride = displayed.channel_stride;
+    unsigned char* data = displayed.data;
+    switch (orientation) {
+    case 2: // mirrored horizontally
+        return image_view(data + last_x, width, height, spectrum, -x_stride, row_stride, channel_stride);
+    case 3: // rotated 180
+        return image_view(data + last_x + last_y, width, height, spectrum, -x_stride, -row_stride, channel_stride);
+    case 4: // mirrored vertically
+        return image_view(data + last_y, width, height, spectrum, x_stride, -row_stride, channel_stride);
+    case 5: // transposed
+        return image_view(data, height, width, spectrum, row_stride, x_stride, channel_stride);
+    case 6: // needs a 90 degree clockwise rotation
+        return image_view(data + last_x, height, width, spectrum, row_stride, -x_stride, channel_stride);
+    case 7: // transversed
+        return image_view(data + last_x + last_y, height, width, spectrum, -row_stride, -x_stride, channel_stride);
+    case 8: // needs a 90 degree counter-clockwise rotation
+        return image_view(data + last_y, height, width, spectrum, -row_stride, x_stride, channel_stride);
+    default:
+        return displayed;
+    }
+}
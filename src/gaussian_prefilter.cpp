@@ -0,0 +1,136 @@
+#include "gaussian_prefilter.h"
+#include "kernel_dispatch.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace {
+
+// Number of stacked box blurs approximating the Gaussian
+const int box_count = 3;
+
+// Widest box, which keeps the scaled running sums within 32 bits
+const int maximum_box_width = 4095;
+
+// Box means are running sums multiplied by 2^24 / width
+const int mean_shift = 24;
+
+// Radii of the box blurs whose succession has the variance of a Gaussian of standard
+// deviation sigma: the widths are the odd integers just below and above the ideal one,
+// the narrower for as many passes as gets closest to the variance
+void box_radii(float sigma, int radii[box_count]) {
+    double variance = 12.0 * sigma * sigma;
+    int lower = static_cast<int>(std::sqrt(variance / box_count + 1));
+    if (lower % 2 == 0) {
+        --lower;
+    }
+    lower = std::min(std::max(lower, 1), maximum_box_width - 2);
+    int lower_count = static_cast<int>(std::lround((variance - box_count * lower * lower - 4.0 * box_count * lower - 3.0 * box_count) / (-4.0 * lower - 4)));
+    lower_count = std::min(std::max(lower_count, 0), box_count);
+    for (int i = 0; i < box_count; ++i) {
+        int width = i < lower_count ? lower : lower + 2;
+        radii[i] = width / 2;
+    }
+}
+
+// Box mean of a running sum over a box of 2 * radius + 1 samples
+struct box_mean {
+    explicit box_mean(int radius) : inverse(((1u << mean_shift) + radius) / (2 * radius + 1)) {}
+
+    unsigned char operator()(std::uint32_t sum) const {
+        return static_cast<unsigned char>((sum * inverse + (1u << (mean_shift - 1))) >> mean_shift);
+    }
+
+    std::uint32_t inverse;
+};
+
+// Repeats the edge samples of a row of count samples into the padding of padding samples
+// on each side
+void pad_row(unsigned char* row, int count, int padding) {
+    std::fill(row, row + padding, row[padding]);
+    std::fill(row + padding + count, row + 2 * padding + count + 1, row[padding + count - 1]);
+}
+
+// Blurs a row of count samples with a box of 2 * radius + 1 samples. The samples start
+// after padding copies of the first one and are followed by padding + 1 copies of the last
+// one, with radius at most padding, so the running sum never needs clamping.
+void box_pass(const unsigned char* in, int count, int padding, int radius, unsigned char* out) {
+    box_mean mean(radius);
+    const unsigned char* samples = in + padding;
+    std::uint32_t sum = 0;
+    for (int k = -radius; k <= radius; ++k) {
+        sum += samples[k];
+    }
+    for (int x = 0; x < count; ++x) {
+        out[x] = mean(sum);
+        sum += samples[x + radius + 1] - samples[x - radius];
+    }
+}
+
+// Blurs the columns of a plane of width x height contiguous pixels with a box of
+// 2 * radius + 1 rows, repeating the edge rows; the running sums of all columns are
+// updated together, one row at a time
+RESIZE_KERNEL_CLONES
+void column_pass(const unsigned char* in, int width, int height, int radius, std::uint32_t* sums, unsigned char* out) {
+    box_mean mean(radius);
+    std::fill(sums, sums + width, 0);
+    for (int k = -radius; k <= radius; ++k) {
+        const unsigned char* row = in + static_cast<std::ptrdiff_t>(std::min(std::max(k, 0), height - 1)) * width;
+        for (int x = 0; x < width; ++x) {
+            sums[x] += row[x];
+        }
+    }
+    for (int y = 0; y < height; ++y) {
+        unsigned char* result = out + static_cast<std::ptrdiff_t>(y) * width;
+        const unsigned char* entering = in + static_cast<std::ptrdiff_t>(std::min(y + radius + 1, height - 1)) * width;
+        const unsigned char* leaving = in + static_cast<std::ptrdiff_t>(std::max(y - radius, 0)) * width;
+        for (int x = 0; x < width; ++x) {
+            result[x] = mean(sums[x]);
+            sums[x] += entering[x] - leaving[x];
+        }
+    }
+}
+
+} // namespace
+
+float gaussian_prefilter::sigma_for(float ratio) {
+    return ratio > 1.0f ? (ratio - 1.0f) / 2.0f : 0.0f;
+}
+
+const_image_view gaussian_prefilter::apply(const const_image_view& source, int x, int y, int width, int height, float sigma_x, float sigma_y) {
+    int x_radii[box_count];
+    int y_radii[box_count];
+    box_radii(sigma_x, x_radii);
+    box_radii(sigma_y, y_radii);
+
+    std::size_t plane = static_cast<std::size_t>(width) * height;
+    pixels_.resize(plane * source.spectrum);
+    scratch_.resize(plane);
+    int padding = *std::max_element(x_radii, x_radii + box_count);
+    std::vector<unsigned char> row(width + 2 * padding + 1);
+    std::vector<unsigned char> blurred_row(width + 2 * padding + 1);
+    std::vector<std::uint32_t> sums(width);
+
+    for (int c = 0; c < source.spectrum; ++c) {
+        unsigned char* result = &pixels_[c * plane];
+        // Rows, with the three passes fused: gathered, blurred back and forth between two
+        // padded row buffers and stored in the scratch plane
+        for (int j = 0; j < height; ++j) {
+            const unsigned char* pixels = source.row(y + j, c) + x * source.x_stride;
+            for (int i = 0; i < width; ++i) {
+                row[padding + i] = pixels[i * source.x_stride];
+            }
+            pad_row(row.data(), width, padding);
+            box_pass(row.data(), width, padding, x_radii[0], blurred_row.data() + padding);
+            pad_row(blurred_row.data(), width, padding);
+            box_pass(blurred_row.data(), width, padding, x_radii[1], row.data() + padding);
+            pad_row(row.data(), width, padding);
+            box_pass(row.data(), width, padding, x_radii[2], &scratch_[static_cast<std::size_t>(j) * width]);
+        }
+        // Columns, ending in the result plane
+        column_pass(scratch_.data(), width, height, y_radii[0], sums.data(), result);
+        column_pass(result, width, height, y_radii[1], sums.data(), scratch_.data());
+        column_pass(scratch_.data(), width, height, y_radii[2], sums.data(), result);
+    }
+    return const_image_view::planar(pixels_.data(), width, height, source.spectrum);
+}
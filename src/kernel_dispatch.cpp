@@ -0,0 +1,18 @@
+#include "kernel_dispatch.h"
+
+const char* kernel_target() {
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && defined(__linux__)
+    // Same checks, in the same order, as the resolvers of the cloned kernels
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("x86-64-v4")) {
+        return "x86-64-v4";
+    }
+    if (__builtin_cpu_supports("x86-64-v3")) {
+        return "x86-64-v3";
+    }
+    if (__builtin_cpu_supports("x86-64-v2")) {
+        return "x86-64-v2";
+    }
+#endif
+    return "default";
+}
@@ -1,60 +1,274 @@
 #include "CImg.h"
+#include "cimg_adapter.h"
 #include "resize_nearest_neighbour.h"
 #include "resize_bilinear.h"
+#include "exif_orientation.h"
+#include "resize_job.h"
+#include "resize_server.h"
+#include "kernel_dispatch.h"
+#include <algorithm>
+#include <atomic>
+#include <csignal>
 #include <sstream>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 using namespace cimg_library;
 
 /**
- * @brief Resizes an image using the specified resizer and saves the result.
+ * @brief Resizes an image to several scales using the specified resizer and saves the results.
  * 
  * @param resizer The resizer object that implements the resize method.
  * @param image The original image to be resized.
- * @param scale_factor The factor by which to scale the image.
+ * @param scale_factors The factors by which to scale the image.
  * @param method The name of the resizing method (used for output filename and logging).
+ * @param orientation The EXIF orientation of the image, applied during the resize.
  */
 
 
-void resize_and_save(const resize_image_base& resizer, const CImg<unsigned char>& image, float scale_factor, const std::string& method) {
-    // Calculate new dimensions based on the scale factor
-    int new_width = static_cast<int>(image.width() * scale_factor);
-    int new_height = static_cast<int>(image.height() * scale_factor);
+void resize_and_save(const resize_image_base& resizer, const CImg<unsigned char>& image, const std::vector<float>& scale_factors, const std::string& method, int orientation) {
+    // Calculate new dimensions based on the scale factors, in display orientation
+    std::vector<image_size> sizes;
+    for (float scale_factor : scale_factors) {
+        int new_width = static_cast<int>(image.width() * scale_factor);
+        int new_height = static_cast<int>(image.height() * scale_factor);
+        if (orientation_swaps_axes(orientation)) {
+            std::swap(new_width, new_height);
+        }
+        sizes.push_back(image_size{new_width, new_height});
+    }
 
-    // Resize the image using the specified resizer
-    CImg<unsigned char> resized_image = resizer.resize(image, new_width, new_height);
+    // Resize the image to all sizes, rotating it upright in the same pass by writing each
+    // size through a view of it in the stored orientation
+    std::vector<CImg<unsigned char>> resized_images;
+    std::vector<image_view> destinations;
+    for (const image_size& size : sizes) {
+        resized_images.emplace_back(size.width, size.height, 1, image.spectrum(), 0);
+    }
+    for (CImg<unsigned char>& resized : resized_images) {
+        destinations.push_back(oriented_view(view_of(resized), orientation));
+    }
+    resizer.resize_many(view_of(image), destinations);
 
-    // Create the output filename based on the method and scale factor
-    std::ostringstream output_filename;
-    output_filename << "lenna_resized_" << method << "_" << scale_factor << ".jpg";
+    for (std::size_t i = 0; i < scale_factors.size(); ++i) {
+        // Create the output filename based on the method and scale factor
+        std::ostringstream output_filename;
+        output_filename << "lenna_resized_" << method << "_" << scale_factors[i] << ".jpg";
 
-    // Save the resized image to the output file
-    resized_image.save(output_filename.str().c_str());
+        // Save the resized image to the output file
+        resized_images[i].save(output_filename.str().c_str());
 
-    // Log the resizing operation details
-    std::cout << "Image resized using " << method << " to " << scale_factor * 100 << "% and saved to " << output_filename.str() << std::endl;
-    std::cout << "New dimensions: " << resized_image.width() << "x" << resized_image.height() << std::endl;
+        // Log the resizing operation details
+        std::cout << "Image resized using " << method << " to " << scale_factors[i] * 100 << "% and saved to " << output_filename.str() << std::endl;
+        std::cout << "New dimensions: " << resized_images[i].width() << "x" << resized_images[i].height() << std::endl;
+    }
 }
 
-int main() {
-    // Load the original image from file
-    CImg<unsigned char> image("images/lenna.jpg");
+/**
+ * @brief Resizes the lenna test image to a fixed set of scales with both methods.
+ * 
+ * This is what the program does when run without arguments.
+ */
+void run_demo() {
+    // Load the original image from file, along with its EXIF orientation
+    const char* input_filename = "images/lenna.jpg";
+    CImg<unsigned char> image(input_filename);
+    int orientation = read_exif_orientation(input_filename);
 
     // Create resizer objects for nearest neighbour and bilinear methods
     resize_nearest_neighbour nearest_neighbour_resizer;
     resize_bilinear bilinear_resizer;
 
     // Scale factors to apply
-    float scale_factors[] = {0.5, 0.75, 1.5, 2.0};
-    //float scale_factors[] = {2.25, 3.0, 3.75, 4.5, 5.25};
+    std::vector<float> scale_factors = {0.5, 0.75, 1.5, 2.0};
+    //std::vector<float> scale_factors = {2.25, 3.0, 3.75, 4.5, 5.25};
 
-    // Loop through each scale factor and resize the image using both methods
-    for (float scale_factor : scale_factors) {
-        // Resize and save using nearest neighbour method
-        resize_and_save(nearest_neighbour_resizer, image, scale_factor, "nearest");
-        // Resize and save using bilinear method
-        resize_and_save(bilinear_resizer, image, scale_factor, "bilinear");
+    // Resize and save using nearest neighbour method
+    resize_and_save(nearest_neighbour_resizer, image, scale_factors, "nearest", orientation);
+    // Resize and save using bilinear method
+    resize_and_save(bilinear_resizer, image, scale_factors, "bilinear", orientation);
+}
+
+/**
+ * @brief Prints the command-line usage.
+ */
+void print_usage(std::ostream& out) {
+    out << "Usage: resize_image [options] <input> <output>\n"
+           "       resize_image [options] --manifest <file>\n"
+           "       resize_image [--threads <count>] [--tile-threads <count>] [cache options] --serve <socket>\n"
+           "       resize_image                 (resizes images/lenna.jpg to a few demo scales)\n"
+           "\n"
+           "Options:\n"
+           "  --method <name>              Resize method: nearest, bilinear, box, max, min or mode (default: bilinear)\n"
+           "  --width <pixels>             Output width, the height follows the aspect ratio if omitted\n"
+           "  --height <pixels>            Output height, the width follows the aspect ratio if omitted\n"
+           "  --scale <factor>             Scale factor used when no width or height is given (default: 1)\n"
+           "  --quality <1-100>            JPEG output quality (default: 90)\n"
+           "  --grey <expand|keep>         Output of RGB inputs holding grey pixels: 3 channels or 1 (default: expand)\n"
+           "  --antialias                  Blurs the source of downscales by more than 2 before sampling it\n"
+           "  --tile-threads <count>       Number of threads resizing the tiles of each image (default: 1)\n"
+           "  --threads <count>            Number of jobs processed in parallel (default: 1)\n"
+           "  --manifest <file>            Reads jobs from a file, one '[options] <input> <output>' per line;\n"
+           "                               options given on the command line are the defaults of every line\n"
+           "  --cache-memory <MiB>         Keeps resize results in memory, keyed on the input content (default: off)\n"
+           "  --cache-dir <directory>      Keeps resize results on disk as well, across runs\n"
+           "  --cache-disk <MiB>           Size of the disk cache (default: 1024)\n"
+           "  --serve <socket>             Runs as a service accepting jobs on a Unix domain socket\n"
+           "  --help                       Shows this message\n";
+}
+
+/**
+ * @brief Runs a batch of jobs on a number of worker threads.
+ * 
+ * @param jobs The jobs to run.
+ * @param thread_count The number of worker threads.
+ * @param cache The cache of resize results, or null.
+ * @return int The number of jobs that failed.
+ */
+int run_jobs(const std::vector<resize_job>& jobs, int thread_count, resize_cache* cache) {
+    std::atomic<std::size_t> next_job(0);
+    std::atomic<int> failures(0);
+    std::mutex log_mutex;
+
+    auto worker = [&]() {
+        for (std::size_t i = next_job++; i < jobs.size(); i = next_job++) {
+            try {
+                image_size size = run_job(jobs[i], cache);
+                std::lock_guard<std::mutex> lock(log_mutex);
+                std::cout << jobs[i].input << " -> " << jobs[i].output << " (" << size.width << "x" << size.height << ", " << jobs[i].method << ")" << std::endl;
+            } catch (const std::exception& error) {
+                ++failures;
+                std::lock_guard<std::mutex> lock(log_mutex);
+                std::cerr << "Error: " << jobs[i].input << ": " << error.what() << std::endl;
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int t = 1; t < thread_count; ++t) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : workers) {
+        thread.join();
     }
+    return failures;
+}
+
+/**
+ * @brief Prints the hit and miss counters of a cache.
+ */
+void print_cache_stats(const resize_cache& cache) {
+    resize_cache_stats stats = cache.stats();
+    std::cout << "Cache: " << stats.memory_hits << " memory hits, " << stats.disk_hits << " disk hits, " << stats.misses << " misses ("
+              << stats.memory_bytes / 1024 << " KiB in memory, " << stats.disk_bytes / 1024 << " KiB on disk)" << std::endl;
+}
+
+// Service stopped by SIGINT and SIGTERM
+resize_server* running_server = nullptr;
 
-    return 0;
+void stop_server(int) {
+    if (running_server) {
+        running_server->stop();
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc == 1) {
+        run_demo();
+        return 0;
+    }
+
+    // Errors are reported per job, CImg should not print them as well
+    cimg::exception_mode(0);
+
+    // Separate the batch options from the options describing the jobs
+    std::vector<std::string> job_args;
+    std::string manifest;
+    std::string socket_path;
+    std::string cache_directory;
+    long cache_memory_mib = 0;
+    long cache_disk_mib = 1024;
+    int thread_count = 1;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--help" || arg == "-h") {
+                print_usage(std::cout);
+                return 0;
+            } else if ((arg == "--manifest" || arg == "--threads" || arg == "--serve" || arg.compare(0, 8, "--cache-") == 0) && i + 1 == argc) {
+                throw std::invalid_argument("missing value for " + arg);
+            } else if (arg == "--manifest") {
+                manifest = argv[++i];
+            } else if (arg == "--serve") {
+                socket_path = argv[++i];
+            } else if (arg == "--cache-dir") {
+                cache_directory = argv[++i];
+            } else if (arg == "--cache-memory" || arg == "--cache-disk") {
+                long mib = std::atol(argv[++i]);
+                if (mib < 0 || (mib == 0 && std::string(argv[i]) != "0")) {
+                    throw std::invalid_argument(arg + " must be a size in MiB");
+                }
+                (arg == "--cache-memory" ? cache_memory_mib : cache_disk_mib) = mib;
+            } else if (arg == "--threads") {
+                thread_count = std::atoi(argv[++i]);
+                if (thread_count < 1) {
+                    throw std::invalid_argument("--threads must be a positive number");
+                }
+            } else {
+                job_args.push_back(arg);
+            }
+        }
+
+        std::unique_ptr<resize_cache> cache;
+        if (cache_memory_mib > 0 || !cache_directory.empty()) {
+            cache.reset(new resize_cache(static_cast<std::size_t>(cache_memory_mib) << 20, cache_directory, static_cast<std::size_t>(cache_disk_mib) << 20));
+        }
+
+        if (!socket_path.empty()) {
+            bool tiling_only = job_args.empty() || (job_args.size() == 2 && job_args[0] == "--tile-threads");
+            if (!tiling_only || !manifest.empty()) {
+                throw std::invalid_argument("--serve only accepts --threads and --tile-threads");
+            }
+            resize_job defaults = parse_job_arguments(job_args, resize_job());
+            resize_server server(socket_path, thread_count, cache.get(), defaults.tile_threads);
+            running_server = &server;
+            std::signal(SIGINT, stop_server);
+            std::signal(SIGTERM, stop_server);
+            std::cout << "Serving resize requests on " << socket_path << " with " << kernel_target() << " kernels" << std::endl;
+            server.run();
+            running_server = nullptr;
+            if (cache) {
+                print_cache_stats(*cache);
+            }
+            return 0;
+        }
+
+        resize_job job = parse_job_arguments(job_args, resize_job());
+        std::vector<resize_job> jobs;
+        if (!manifest.empty()) {
+            if (!job.input.empty()) {
+                throw std::invalid_argument("input and output paths cannot be combined with --manifest");
+            }
+            jobs = read_manifest(manifest, job);
+            std::cout << "Running " << jobs.size() << " jobs with " << kernel_target() << " kernels" << std::endl;
+        } else if (job.output.empty()) {
+            throw std::invalid_argument("expected an input and an output path");
+        } else {
+            jobs.push_back(job);
+        }
+
+        int failures = run_jobs(jobs, thread_count, cache.get());
+        if (cache) {
+            print_cache_stats(*cache);
+        }
+        return failures == 0 ? 0 : 1;
+    } catch (const std::exception& error) {
+        std::cerr << "Error: " << error.what() << "\n\n";
+        print_usage(std::cerr);
+        return 1;
+    }
 }
@@ -0,0 +1,190 @@
+#include "mapped_image.h"
+#include <cctype>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const std::size_t bmp_header_size = 54;
+const std::uint32_t bmp_uncompressed = 0;
+
+std::uint32_t read_u32(const unsigned char* bytes) {
+    return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (static_cast<std::uint32_t>(bytes[3]) << 24);
+}
+
+std::uint16_t read_u16(const unsigned char* bytes) {
+    return static_cast<std::uint16_t>(bytes[0] | (bytes[1] << 8));
+}
+
+void check_length(std::size_t needed, std::size_t length, const std::string& path) {
+    if (needed > length) {
+        throw std::runtime_error(path + " is shorter than its pixels require");
+    }
+}
+
+// Describes the pixels of an uncompressed 24 or 32-bit BMP in place: the rows are stored
+// bottom-up unless the height is negative, padded to 4 bytes, with the channels in BGR order
+bool bmp_view(const unsigned char* data, std::size_t length, const std::string& path, const_image_view& view) {
+    if (length < bmp_header_size || data[0] != 'B' || data[1] != 'M') {
+        return false;
+    }
+    std::uint32_t offset = read_u32(data + 10);
+    std::uint32_t info_size = read_u32(data + 14);
+    std::int32_t width = static_cast<std::int32_t>(read_u32(data + 18));
+    std::int32_t height = static_cast<std::int32_t>(read_u32(data + 22));
+    std::uint16_t bits_per_pixel = read_u16(data + 28);
+    std::uint32_t compression = read_u32(data + 30);
+    if (info_size < 40 || width <= 0 || height == 0 || height == INT32_MIN || (bits_per_pixel != 24 && bits_per_pixel != 32) || compression != bmp_uncompressed) {
+        return false;
+    }
+
+    int rows = height < 0 ? -height : height;
+    std::ptrdiff_t row_bytes = (static_cast<std::ptrdiff_t>(width) * bits_per_pixel + 31) / 32 * 4;
+    check_length(offset + row_bytes * rows, length, path);
+
+    const unsigned char* top_row = data + offset;
+    std::ptrdiff_t row_stride = row_bytes;
+    if (height > 0) {
+        top_row += row_bytes * (rows - 1);
+        row_stride = -row_bytes;
+    }
+    // Red is the third byte of a pixel, green and blue precede it
+    view = const_image_view(top_row + 2, width, rows, 3, bits_per_pixel / 8, row_stride, -1);
+    return true;
+}
+
+// Reads a decimal field of a PNM header, skipping the whitespace and comments before it
+bool pnm_field(const unsigned char* data, std::size_t length, std::size_t& position, long& value) {
+    while (position < length && (std::isspace(data[position]) || data[position] == '#')) {
+        if (data[position] == '#') {
+            while (position < length && data[position] != '\n') {
+                ++position;
+            }
+        } else {
+            ++position;
+        }
+    }
+    if (position == length || !std::isdigit(data[position])) {
+        return false;
+    }
+    value = 0;
+    while (position < length && std::isdigit(data[position]) && value < INT32_MAX) {
+        value = value * 10 + (data[position++] - '0');
+    }
+    return true;
+}
+
+// Describes the pixels of a binary PGM (P5) or PPM (P6) with 8-bit samples in place
+bool pnm_view(const unsigned char* data, std::size_t length, const std::string& path, const_image_view& view) {
+    if (length < 3 || data[0] != 'P' || (data[1] != '5' && data[1] != '6')) {
+        return false;
+    }
+    int spectrum = data[1] == '6' ? 3 : 1;
+    std::size_t position = 2;
+    long width;
+    long height;
+    long max_value;
+    if (!pnm_field(data, length, position, width) || !pnm_field(data, length, position, height) || !pnm_field(data, length, position, max_value)
+        || width <= 0 || height <= 0 || width >= INT32_MAX || height >= INT32_MAX || max_value <= 0 || max_value > 255 || position == length) {
+        return false;
+    }
+    // A single whitespace character separates the header from the samples
+    ++position;
+
+    std::ptrdiff_t row_bytes = static_cast<std::ptrdiff_t>(width) * spectrum;
+    check_length(position + row_bytes * height, length, path);
+    view = const_image_view(data + position, static_cast<int>(width), static_cast<int>(height), spectrum, spectrum, row_bytes, 1);
+    return true;
+}
+
+} // namespace
+
+mapped_image::mapped_image() : mapping_(nullptr), length_(0) {}
+
+mapped_image::mapped_image(const std::string& path) : mapping_(nullptr), length_(0) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("cannot open " + path + ": " + std::strerror(errno));
+    }
+    struct stat info;
+    if (fstat(fd, &info) < 0) {
+        int error = errno;
+        close(fd);
+        throw std::runtime_error("cannot read " + path + ": " + std::strerror(error));
+    }
+    length_ = static_cast<std::size_t>(info.st_size);
+    if (length_ > 0) {
+        // The mapping keeps the file alive, the descriptor is not needed any more
+        void* data = mmap(nullptr, length_, PROT_READ, MAP_PRIVATE, fd, 0);
+        int error = errno;
+        close(fd);
+        if (data == MAP_FAILED) {
+            throw std::runtime_error("cannot map " + path + ": " + std::strerror(error));
+        }
+        mapping_ = static_cast<unsigned char*>(data);
+    } else {
+        close(fd);
+    }
+}
+
+mapped_image mapped_image::open(const std::string& path) {
+    mapped_image image(path);
+    if (image.empty() || (!bmp_view(image.mapping_, image.length_, path, image.view_) && !pnm_view(image.mapping_, image.length_, path, image.view_))) {
+        return mapped_image();
+    }
+    return image;
+}
+
+mapped_image mapped_image::open_raw(const std::string& path, int width, int height, int spectrum, raw_layout layout, std::size_t offset) {
+    if (width <= 0 || height <= 0 || spectrum <= 0) {
+        throw std::invalid_argument("raw image dimensions must be positive");
+    }
+    mapped_image image(path);
+    std::size_t samples = static_cast<std::size_t>(width) * height * spectrum;
+    check_length(offset + samples, image.length_, path);
+    const unsigned char* pixels = image.mapping_ + offset;
+    if (layout == raw_layout::planar) {
+        image.view_ = const_image_view::planar(pixels, width, height, spectrum);
+    } else {
+        image.view_ = const_image_view(pixels, width, height, spectrum, spectrum, static_cast<std::ptrdiff_t>(width) * spectrum, 1);
+    }
+    return image;
+}
+
+mapped_image::~mapped_image() {
+    release();
+}
+
+mapped_image::mapped_image(mapped_image&& other) noexcept : mapping_(other.mapping_), length_(other.length_), view_(other.view_) {
+    other.mapping_ = nullptr;
+    other.length_ = 0;
+    other.view_ = const_image_view();
+}
+
+mapped_image& mapped_image::operator=(mapped_image&& other) noexcept {
+    if (this != &other) {
+        release();
+        mapping_ = other.mapping_;
+        length_ = other.length_;
+        view_ = other.view_;
+        other.mapping_ = nullptr;
+        other.length_ = 0;
+        other.view_ = const_image_view();
+    }
+    return *this;
+}
+
+void mapped_image::release() {
+    if (mapping_) {
+        munmap(mapping_, length_);
+        mapping_ = nullptr;
+    }
+    length_ = 0;
+    view_ = const_image_view();
+}
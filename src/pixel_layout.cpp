@@ -0,0 +1,383 @@
+#include "pixel_layout.h"
+#include "kernel_dispatch.h"
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define PIXEL_LAYOUT_SIMD
+#include <immintrin.h>
+#endif
+
+namespace {
+
+void interleave_scalar(const unsigned char* planar, std::ptrdiff_t plane_stride, std::size_t pixel_count, int channels, unsigned char* interleaved) {
+    for (std::size_t i = 0; i < pixel_count; ++i) {
+        for (int c = 0; c < channels; ++c) {
+            interleaved[i * channels + c] = planar[c * plane_stride + i];
+        }
+    }
+}
+
+// Pixels per chunk of the grey detector and of the broadcast. A constant trip count lets
+// the compiler vectorise a chunk without a remainder loop, the rest of a row is scalar.
+const int grey_chunk = 64;
+
+// Whether count pixels of planar red, green and blue rows are grey, one chunk at a time
+inline bool grey_planar(const unsigned char* red, const unsigned char* green, const unsigned char* blue, int count) {
+    int i = 0;
+    for (; i + grey_chunk <= count; i += grey_chunk) {
+        const unsigned char* r = red + i;
+        const unsigned char* g = green + i;
+        const unsigned char* b = blue + i;
+        unsigned char difference = 0;
+        for (int k = 0; k < grey_chunk; ++k) {
+            difference |= (r[k] ^ g[k]) | (r[k] ^ b[k]);
+        }
+        if (difference) {
+            return false;
+        }
+    }
+    unsigned char difference = 0;
+    for (; i < count; ++i) {
+        difference |= (red[i] ^ green[i]) | (red[i] ^ blue[i]);
+    }
+    return difference == 0;
+}
+
+// Whether count interleaved pixels of the given channel count are grey, one chunk at a time
+template<int channels>
+inline bool grey_interleaved(const unsigned char* pixels, int count) {
+    int i = 0;
+    for (; i + grey_chunk <= count; i += grey_chunk) {
+        const unsigned char* chunk = pixels + static_cast<std::ptrdiff_t>(i) * channels;
+        unsigned char difference = 0;
+        for (int k = 0; k < grey_chunk; ++k) {
+            difference |= (chunk[k * channels] ^ chunk[k * channels + 1]) | (chunk[k * channels] ^ chunk[k * channels + 2]);
+        }
+        if (difference) {
+            return false;
+        }
+    }
+    unsigned char difference = 0;
+    for (; i < count; ++i) {
+        const unsigned char* pixel = pixels + static_cast<std::ptrdiff_t>(i) * channels;
+        difference |= (pixel[0] ^ pixel[1]) | (pixel[0] ^ pixel[2]);
+    }
+    return difference == 0;
+}
+
+// Whether a row of an image is grey, cloned per instruction set level
+RESIZE_KERNEL_CLONES
+bool grey_row(const const_image_view& image, int y) {
+    if (image.x_stride == 1) {
+        return grey_planar(image.row(y, 0), image.row(y, 1), image.row(y, 2), image.width);
+    }
+    if (image.channel_stride == 1 && image.x_stride == 3) {
+        return grey_interleaved<3>(image.row(y, 0), image.width);
+    }
+    if (image.channel_stride == 1 && image.x_stride == 4) {
+        return grey_interleaved<4>(image.row(y, 0), image.width);
+    }
+    for (int x = 0; x < image.width; ++x) {
+        if (image(x, y, 0) != image(x, y, 1) || image(x, y, 0) != image(x, y, 2)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Copies the first channel of count interleaved pixels into the next two, one chunk at a time
+template<int channels>
+inline void broadcast_interleaved(unsigned char* pixels, int count) {
+    int i = 0;
+    for (; i + grey_chunk <= count; i += grey_chunk) {
+        unsigned char* chunk = pixels + static_cast<std::ptrdiff_t>(i) * channels;
+        for (int k = 0; k < grey_chunk; ++k) {
+            chunk[k * channels + 1] = chunk[k * channels];
+            chunk[k * channels + 2] = chunk[k * channels];
+        }
+    }
+    for (; i < count; ++i) {
+        unsigned char* pixel = pixels + static_cast<std::ptrdiff_t>(i) * channels;
+        pixel[1] = pixel[0];
+        pixel[2] = pixel[0];
+    }
+}
+
+// Copies the first channel of a row of an image into the next two, cloned per instruction
+// set level
+RESIZE_KERNEL_CLONES
+void broadcast_row(const image_view& image, int y) {
+    if (image.x_stride == 1) {
+        std::memcpy(image.row(y, 1), image.row(y, 0), image.width);
+        std::memcpy(image.row(y, 2), image.row(y, 0), image.width);
+    } else if (image.channel_stride == 1 && image.x_stride == 3) {
+        broadcast_interleaved<3>(image.row(y, 0), image.width);
+    } else if (image.channel_stride == 1 && image.x_stride == 4) {
+        broadcast_interleaved<4>(image.row(y, 0), image.width);
+    } else {
+        for (int x = 0; x < image.width; ++x) {
+            image(x, y, 1) = image(x, y, 0);
+            image(x, y, 2) = image(x, y, 0);
+        }
+    }
+}
+
+void deinterleave_scalar(const unsigned char* interleaved, std::size_t pixel_count, int channels, unsigned char* planar, std::ptrdiff_t plane_stride) {
+    for (std::size_t i = 0; i < pixel_count; ++i) {
+        for (int c = 0; c < channels; ++c) {
+            planar[c * plane_stride + i] = interleaved[i * channels + c];
+        }
+    }
+}
+
+#ifdef PIXEL_LAYOUT_SIMD
+
+// Shuffle masks converting 16 pixels of N channels. Interleaved vector j is the OR of the
+// planes shuffled with to_interleaved[j][c]; plane c is the OR of the interleaved vectors
+// shuffled with to_planar[c][j]. Bytes set to 0x80 are zeroed by the shuffle.
+template<int N>
+struct shuffle_masks {
+    alignas(16) unsigned char to_interleaved[N][N][16];
+    alignas(16) unsigned char to_planar[N][N][16];
+
+    shuffle_masks() {
+        for (int j = 0; j < N; ++j) {
+            for (int c = 0; c < N; ++c) {
+                for (int i = 0; i < 16; ++i) {
+                    int byte = 16 * j + i;
+                    to_interleaved[j][c][i] = byte % N == c ? static_cast<unsigned char>(byte / N) : 0x80;
+                    int source = N * i + c;
+                    to_planar[c][j][i] = source / 16 == j ? static_cast<unsigned char>(source % 16) : 0x80;
+                }
+            }
+        }
+    }
+};
+
+template<int N>
+const shuffle_masks<N>& masks() {
+    static const shuffle_masks<N> instance;
+    return instance;
+}
+
+// 16 pixels per iteration, returns the number of pixels converted
+template<int N>
+__attribute__((target("ssse3")))
+std::size_t interleave_ssse3(const unsigned char* planar, std::ptrdiff_t plane_stride, std::size_t pixel_count, unsigned char* interleaved) {
+    const shuffle_masks<N>& m = masks<N>();
+    __m128i mask[N][N];
+    for (int j = 0; j < N; ++j) {
+        for (int c = 0; c < N; ++c) {
+            mask[j][c] = _mm_load_si128(reinterpret_cast<const __m128i*>(m.to_interleaved[j][c]));
+        }
+    }
+    std::size_t i = 0;
+    for (; i + 16 <= pixel_count; i += 16) {
+        __m128i plane[N];
+        for (int c = 0; c < N; ++c) {
+            plane[c] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(planar + c * plane_stride + i));
+        }
+        for (int j = 0; j < N; ++j) {
+            __m128i out = _mm_shuffle_epi8(plane[0], mask[j][0]);
+            for (int c = 1; c < N; ++c) {
+                out = _mm_or_si128(out, _mm_shuffle_epi8(plane[c], mask[j][c]));
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(interleaved + N * i + 16 * j), out);
+        }
+    }
+    return i;
+}
+
+template<int N>
+__attribute__((target("ssse3")))
+std::size_t deinterleave_ssse3(const unsigned char* interleaved, std::size_t pixel_count, unsigned char* planar, std::ptrdiff_t plane_stride) {
+    const shuffle_masks<N>& m = masks<N>();
+    __m128i mask[N][N];
+    for (int c = 0; c < N; ++c) {
+        for (int j = 0; j < N; ++j) {
+            mask[c][j] = _mm_load_si128(reinterpret_cast<const __m128i*>(m.to_planar[c][j]));
+        }
+    }
+    std::size_t i = 0;
+    for (; i + 16 <= pixel_count; i += 16) {
+        __m128i in[N];
+        for (int j = 0; j < N; ++j) {
+            in[j] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(interleaved + N * i + 16 * j));
+        }
+        for (int c = 0; c < N; ++c) {
+            __m128i out = _mm_shuffle_epi8(in[0], mask[c][0]);
+            for (int j = 1; j < N; ++j) {
+                out = _mm_or_si128(out, _mm_shuffle_epi8(in[j], mask[c][j]));
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(planar + c * plane_stride + i), out);
+        }
+    }
+    return i;
+}
+
+// 32 pixels per iteration: each 128-bit lane converts 16 of them with the SSSE3 masks
+template<int N>
+__attribute__((target("avx2")))
+std::size_t interleave_avx2(const unsigned char* planar, std::ptrdiff_t plane_stride, std::size_t pixel_count, unsigned char* interleaved) {
+    const shuffle_masks<N>& m = masks<N>();
+    __m256i mask[N][N];
+    for (int j = 0; j < N; ++j) {
+        for (int c = 0; c < N; ++c) {
+            mask[j][c] = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(m.to_interleaved[j][c])));
+        }
+    }
+    std::size_t i = 0;
+    for (; i + 32 <= pixel_count; i += 32) {
+        __m256i plane[N];
+        for (int c = 0; c < N; ++c) {
+            plane[c] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(planar + c * plane_stride + i));
+        }
+        for (int j = 0; j < N; ++j) {
+            __m256i out = _mm256_shuffle_epi8(plane[0], mask[j][0]);
+            for (int c = 1; c < N; ++c) {
+                out = _mm256_or_si256(out, _mm256_shuffle_epi8(plane[c], mask[j][c]));
+            }
+            // The upper lane holds the second group of 16 pixels
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(interleaved + N * i + 16 * j), _mm256_castsi256_si128(out));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(interleaved + N * (i + 16) + 16 * j), _mm256_extracti128_si256(out, 1));
+        }
+    }
+    return i;
+}
+
+template<int N>
+__attribute__((target("avx2")))
+std::size_t deinterleave_avx2(const unsigned char* interleaved, std::size_t pixel_count, unsigned char* planar, std::ptrdiff_t plane_stride) {
+    const shuffle_masks<N>& m = masks<N>();
+    __m256i mask[N][N];
+    for (int c = 0; c < N; ++c) {
+        for (int j = 0; j < N; ++j) {
+            mask[c][j] = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(m.to_planar[c][j])));
+        }
+    }
+    std::size_t i = 0;
+    for (; i + 32 <= pixel_count; i += 32) {
+        __m256i in[N];
+        for (int j = 0; j < N; ++j) {
+            __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(interleaved + N * i + 16 * j));
+            __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i*>(interleaved + N * (i + 16) + 16 * j));
+            in[j] = _mm256_inserti128_si256(_mm256_castsi128_si256(first), second, 1);
+        }
+        for (int c = 0; c < N; ++c) {
+            __m256i out = _mm256_shuffle_epi8(in[0], mask[c][0]);
+            for (int j = 1; j < N; ++j) {
+                out = _mm256_or_si256(out, _mm256_shuffle_epi8(in[j], mask[c][j]));
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(planar + c * plane_stride + i), out);
+        }
+    }
+    return i;
+}
+
+enum class simd_level { none, ssse3, avx2 };
+
+simd_level detect_simd_level() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return simd_level::avx2;
+    }
+    if (__builtin_cpu_supports("ssse3")) {
+        return simd_level::ssse3;
+    }
+    return simd_level::none;
+}
+
+const simd_level host_simd_level = detect_simd_level();
+
+template<int N>
+std::size_t interleave_simd(const unsigned char* planar, std::ptrdiff_t plane_stride, std::size_t pixel_count, unsigned char* interleaved) {
+    switch (host_simd_level) {
+    case simd_level::avx2:
+        return interleave_avx2<N>(planar, plane_stride, pixel_count, interleaved);
+    case simd_level::ssse3:
+        return interleave_ssse3<N>(planar, plane_stride, pixel_count, interleaved);
+    default:
+        return 0;
+    }
+}
+
+template<int N>
+std::size_t deinterleave_simd(const unsigned char* interleaved, std::size_t pixel_count, unsigned char* planar, std::ptrdiff_t plane_stride) {
+    switch (host_simd_level) {
+    case simd_level::avx2:
+        return deinterleave_avx2<N>(interleaved, pixel_count, planar, plane_stride);
+    case simd_level::ssse3:
+        return deinterleave_ssse3<N>(interleaved, pixel_count, planar, plane_stride);
+    default:
+        return 0;
+    }
+}
+
+#endif // PIXEL_LAYOUT_SIMD
+
+} // namespace
+
+void interleave_pixels(const unsigned char* planar, std::ptrdiff_t plane_stride, std::size_t pixel_count, int channels, unsigned char* interleaved) {
+    std::size_t done = 0;
+#ifdef PIXEL_LAYOUT_SIMD
+    if (channels == 3) {
+        done = interleave_simd<3>(planar, plane_stride, pixel_count, interleaved);
+    } else if (channels == 4) {
+        done = interleave_simd<4>(planar, plane_stride, pixel_count, interleaved);
+    }
+#endif
+    interleave_scalar(planar + done, plane_stride, pixel_count - done, channels, interleaved + done * channels);
+}
+
+void deinterleave_pixels(const unsigned char* interleaved, std::size_t pixel_count, int channels, unsigned char* planar, std::ptrdiff_t plane_stride) {
+    std::size_t done = 0;
+#ifdef PIXEL_LAYOUT_SIMD
+    if (channels == 3) {
+        done = deinterleave_simd<3>(interleaved, pixel_count, planar, plane_stride);
+    } else if (channels == 4) {
+        done = deinterleave_simd<4>(interleaved, pixel_count, planar, plane_stride);
+    }
+#endif
+    deinterleave_scalar(interleaved + done * channels, pixel_count - done, channels, planar + done, plane_stride);
+}
+
+void copy_pixels(const const_image_view& source, const image_view& destination) {
+    if (source.width != destination.width || source.height != destination.height || source.spectrum != destination.spectrum) {
+        throw std::invalid_argument("cannot copy pixels between images of different dimensions");
+    }
+    for (int y = 0; y < source.height; ++y) {
+        if (source.has_contiguous_pixels() && destination.has_contiguous_rows()) {
+            deinterleave_pixels(source.row(y, 0), source.width, source.spectrum, destination.row(y, 0), destination.channel_stride);
+        } else if (source.has_contiguous_rows() && destination.has_contiguous_pixels()) {
+            interleave_pixels(source.row(y, 0), source.channel_stride, source.width, source.spectrum, destination.row(y, 0));
+        } else {
+            for (int c = 0; c < source.spectrum; ++c) {
+                for (int x = 0; x < source.width; ++x) {
+                    destination(x, y, c) = source(x, y, c);
+                }
+            }
+        }
+    }
+}
+
+bool is_grey(const const_image_view& image) {
+    if (image.spectrum < 3) {
+        return false;
+    }
+    for (int y = 0; y < image.height; ++y) {
+        if (!grey_row(image, y)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void broadcast_grey(const image_view& image) {
+    if (image.spectrum < 3) {
+        throw std::invalid_argument("broadcasting grey pixels needs at least 3 channels");
+    }
+    for (int y = 0; y < image.height; ++y) {
+        broadcast_row(image, y);
+    }
+}
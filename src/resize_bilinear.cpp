@@ -1,45 +1,244 @@
 #include "resize_bilinear.h"
+#include "resize_kernels.h"
+#include "kernel_dispatch.h"
+#include "resize_tiles.h"
+#include "resize_exact.h"
 #include <algorithm>
 #include <cmath>
-#include <iostream>
+#include <vector>
 
-using namespace cimg_library;
+namespace {
 
-cimg_library::CImg<unsigned char> resize_bilinear::resize(const cimg_library::CImg<unsigned char>& source, int new_width, int new_height) const {
-    cimg_library::CImg<unsigned char> result(new_width, new_height, 1, source.spectrum(), 0);
-    float x_ratio = static_cast<float>(source.width()) / new_width;
-    float y_ratio = static_cast<float>(source.height()) / new_height;
+// Ring of horizontally resampled source rows, keyed by source row index. Consecutive
+// destination rows often blend the same source rows (all of them do when upscaling), which
+// are then resampled once for all of them instead of once per destination row.
+class resampled_rows {
+public:
+    explicit resampled_rows(std::size_t row_length) : samples_(2 * row_length), row_length_(row_length) {}
 
-    for (int y = 0; y < new_height; ++y) {
-        for (int x = 0; x < new_width; ++x) {
-            for (int c = 0; c < source.spectrum(); ++c) {
-                float src_x = x * x_ratio;
-                float src_y = y * y_ratio;
-                result(x, y, 0, c) = estimate_color(source, src_x, src_y, c);
+    // Returns the slot of a source row and tells whether it already holds it; the slot of
+    // keep_row, needed for the same destination row, is never the one reused
+    float* find(int source_row, int keep_row, bool& cached) {
+        for (int i = 0; i < 2; ++i) {
+            if (keys_[i] == source_row) {
+                cached = true;
+                return &samples_[i * row_length_];
             }
         }
+        int slot = keys_[0] == keep_row ? 1 : 0;
+        keys_[slot] = source_row;
+        cached = false;
+        return &samples_[slot * row_length_];
     }
 
-    return result;
+private:
+    std::vector<float> samples_;
+    std::size_t row_length_;
+    int keys_[2] = {-1, -1};
+};
+
+// Horizontal pass over interleaved source pixels with a constant channel count
+template<int channels>
+inline void resample_pixels(const resize_kernels::axis_table& columns, const unsigned char* source_row, int x_begin, int x_end, float* resampled) {
+    for (int x = x_begin; x < x_end; ++x) {
+        std::ptrdiff_t left = static_cast<std::ptrdiff_t>(columns.first[x]) * channels;
+        std::ptrdiff_t right = static_cast<std::ptrdiff_t>(columns.second[x]) * channels;
+        float x_frac = columns.fraction[x];
+        for (int c = 0; c < channels; ++c) {
+            *resampled++ = resize_kernels::interpolate(source_row[left + c], source_row[right + c], x_frac);
+        }
+    }
 }
 
-unsigned char resize_bilinear::estimate_color(const cimg_library::CImg<unsigned char>& source, float x, float y, int channel) const {
-    int x1 = static_cast<int>(x);
-    int y1 = static_cast<int>(y);
-    int x2 = std::min(x1 + 1, source.width() - 1);
-    int y2 = std::min(y1 + 1, source.height() - 1);
+// Resamples the columns [x_begin, x_end) of a source row horizontally, into interleaved
+// samples when the destination is interleaved and into one run per channel otherwise
+RESIZE_KERNEL_CLONES
+void resample_row(const const_image_view& source, const resize_kernels::axis_table& columns, int source_row, int x_begin, int x_end, bool interleaved, float* resampled) {
+    if (interleaved && source.has_contiguous_pixels()) {
+        const unsigned char* row = source.row(source_row, 0);
+        switch (source.spectrum) {
+        case 1:
+            resample_pixels<1>(columns, row, x_begin, x_end, resampled);
+            return;
+        case 3:
+            resample_pixels<3>(columns, row, x_begin, x_end, resampled);
+            return;
+        case 4:
+            resample_pixels<4>(columns, row, x_begin, x_end, resampled);
+            return;
+        }
+    }
+    int count = x_end - x_begin;
+    std::ptrdiff_t x_step = interleaved ? source.spectrum : 1;
+    std::ptrdiff_t channel_step = interleaved ? 1 : count;
+    for (int c = 0; c < source.spectrum; ++c) {
+        for (int x = x_begin; x < x_end; ++x) {
+            float left = source(columns.first[x], source_row, c);
+            float right = source(columns.second[x], source_row, c);
+            resampled[(x - x_begin) * x_step + c * channel_step] = resize_kernels::interpolate(left, right, columns.fraction[x]);
+        }
+    }
+}
+
+// Vertical pass: blends two resampled rows into the columns [x_begin, x_end) of a destination row
+RESIZE_KERNEL_CLONES
+void blend_rows(const float* top, const float* bottom, float y_frac, int x_begin, int x_end, bool interleaved, const image_view& destination, int y) {
+    int count = x_end - x_begin;
+    if (interleaved) {
+        unsigned char* row = destination.row(y, 0) + static_cast<std::ptrdiff_t>(x_begin) * destination.spectrum;
+        int samples = count * destination.spectrum;
+        for (int i = 0; i < samples; ++i) {
+            row[i] = static_cast<unsigned char>(resize_kernels::interpolate(top[i], bottom[i], y_frac));
+        }
+        return;
+    }
+    for (int c = 0; c < destination.spectrum; ++c) {
+        for (int x = x_begin; x < x_end; ++x) {
+            int i = c * count + x - x_begin;
+            destination(x, y, c) = static_cast<unsigned char>(resize_kernels::interpolate(top[i], bottom[i], y_frac));
+        }
+    }
+}
+
+// Warps the columns [x_begin, x_end) of one destination row, all of whose taps lie inside
+// the source, stepping the source coordinates from column to column
+RESIZE_KERNEL_CLONES
+void bilinear_warp_span(const const_image_view& source, double x_step, double y_step, double& src_x, double& src_y, int x_begin, int x_end, const image_view& destination, int y) {
+    double x_position = src_x;
+    double y_position = src_y;
+    for (int x = x_begin; x < x_end; ++x) {
+        for (int c = 0; c < source.spectrum; ++c) {
+            destination(x, y, c) = resize_kernels::bilinear_sample_inside(source, static_cast<float>(x_position), static_cast<float>(y_position), c);
+        }
+        x_position += x_step;
+        y_position += y_step;
+    }
+    src_x = x_position;
+    src_y = y_position;
+}
+
+// One size of a shared pass over the source rows: its tables, the resampled source rows
+// its pending destination rows blend, and the first destination row not written yet
+struct shared_output {
+    shared_output(const const_image_view& source, const image_view& destination)
+        : destination(destination), interleaved(destination.has_contiguous_pixels()), ring(static_cast<std::size_t>(destination.width) * source.spectrum) {
+        float x_ratio = static_cast<float>(source.width) / destination.width;
+        float y_ratio = static_cast<float>(source.height) / destination.height;
+        columns = resize_kernels::bilinear_axis(0.0f, x_ratio, static_cast<float>(source.width - 1), destination.width, source.width);
+        rows = resize_kernels::bilinear_axis(0.0f, y_ratio, static_cast<float>(source.height - 1), destination.height, source.height);
+    }
+
+    image_view destination;
+    bool interleaved;
+    resampled_rows ring;
+    resize_kernels::axis_table columns;
+    resize_kernels::axis_table rows;
+    int next_row = 0;
+};
 
-    float x_frac = x - x1;
-    float y_frac = y - y1;
+} // namespace
 
-    float top = interpolate(source(x1, y1, 0, channel), source(x2, y1, 0, channel), x_frac);
-    float bottom = interpolate(source(x1, y2, 0, channel), source(x2, y2, 0, channel), x_frac);
+void resize_bilinear::resize_region(const const_image_view& source, const image_region& region, const image_view& destination) const {
+    image_region clipped = clip_region(source, region, destination);
 
-    //std::cout << "Bilinear estimate color at (" << x << ", " << y << ") in channel " << channel << std::endl;
+    // Large downscales sample a blurred copy of the region when antialiasing is enabled
+    gaussian_prefilter prefilter;
+    const_image_view sampled = prefiltered_source(source, clipped, destination, prefilter);
+    int new_width = destination.width;
+    int new_height = destination.height;
+    float x_ratio = clipped.width / new_width;
+    float y_ratio = clipped.height / new_height;
 
-    return static_cast<unsigned char>(interpolate(top, bottom, y_frac));
+    // Last source pixel overlapping the region, so that no sample reaches outside of it
+    float x_last = std::ceil(clipped.x + clipped.width) - 1;
+    float y_last = std::ceil(clipped.y + clipped.height) - 1;
+
+    std::vector<image_tile> tiles = plan_tiles(new_width, new_height, sampled.spectrum, x_ratio, y_ratio, tiling());
+
+    // Halving and doubling have their own integer kernels, giving the same pixels
+    exact_ratio exact = detect_exact_ratio(clipped, x_ratio, y_ratio);
+    if (exact != exact_ratio::none) {
+        int x0 = static_cast<int>(clipped.x);
+        int y0 = static_cast<int>(clipped.y);
+        for_each_tile(tiles, tiling().thread_count, [&](const image_tile& tile) {
+            for (int y = tile.y; y < tile.y + tile.height; ++y) {
+                if (exact == exact_ratio::half) {
+                    halve_span(sampled, x0, y0, y, tile.x, tile.x + tile.width, destination);
+                } else {
+                    double_span(sampled, x0, y0, static_cast<int>(x_last), static_cast<int>(y_last), y, tile.x, tile.x + tile.width, destination);
+                }
+            }
+        });
+        return;
+    }
+
+    // The tables are shared by all tiles, each tile only touches the source pixels it samples
+    resize_kernels::axis_table columns = resize_kernels::bilinear_axis(clipped.x, x_ratio, x_last, new_width, sampled.width);
+    resize_kernels::axis_table rows = resize_kernels::bilinear_axis(clipped.y, y_ratio, y_last, new_height, sampled.height);
+
+    // Separable passes: each source row a tile needs is resampled horizontally once, then
+    // every destination row is a vertical blend of two resampled rows
+    bool interleaved = destination.has_contiguous_pixels();
+    for_each_tile(tiles, tiling().thread_count, [&](const image_tile& tile) {
+        resampled_rows ring(static_cast<std::size_t>(tile.width) * sampled.spectrum);
+        int x_end = tile.x + tile.width;
+        for (int y = tile.y; y < tile.y + tile.height; ++y) {
+            int y1 = rows.first[y];
+            int y2 = rows.second[y];
+            bool cached;
+            float* top = ring.find(y1, y2, cached);
+            if (!cached) {
+                resample_row(sampled, columns, y1, tile.x, x_end, interleaved, top);
+            }
+            float* bottom = ring.find(y2, y1, cached);
+            if (!cached) {
+                resample_row(sampled, columns, y2, tile.x, x_end, interleaved, bottom);
+            }
+            blend_rows(top, bottom, rows.fraction[y], tile.x, x_end, interleaved, destination, y);
+        }
+    });
+}
+
+unsigned char resize_bilinear::estimate_color(const const_image_view& source, float x, float y, int channel, edge_mode edges) const {
+    return resize_kernels::bilinear_sample(source, x, y, channel, edges);
+}
+
+void resize_bilinear::warp_inside(const const_image_view& source, const affine_transform& transform, double& src_x, double& src_y, int x_begin, int x_end, const image_view& destination, int y) const {
+    bilinear_warp_span(source, transform.xx, transform.yx, src_x, src_y, x_begin, x_end, destination, y);
 }
 
-float resize_bilinear::interpolate(float start, float end, float factor) const {
-    return start + factor * (end - start);
+void resize_bilinear::resize_many(const const_image_view& source, const std::vector<image_view>& destinations) const {
+    // Prefiltering blurs the source differently for each size, and threads split the tiles
+    // of a single size, so both keep to one resize per size
+    if (antialiasing() || tiling().thread_count > 1) {
+        resize_image_base::resize_many(source, destinations);
+        return;
+    }
+    std::vector<shared_output> outputs;
+    outputs.reserve(destinations.size());
+    for (const image_view& destination : destinations) {
+        clip_region(source, image_region{0.0f, 0.0f, static_cast<float>(source.width), static_cast<float>(source.height)}, destination);
+        outputs.emplace_back(source, destination);
+    }
+
+    // Source rows are read in order, each once for all sizes: a size resamples the row if
+    // its next destination row blends it, then writes every row whose two source rows are in
+    for (int source_row = 0; source_row < source.height; ++source_row) {
+        for (shared_output& output : outputs) {
+            const resize_kernels::axis_table& rows = output.rows;
+            int y = output.next_row;
+            if (y == output.destination.height || (rows.first[y] != source_row && rows.second[y] != source_row)) {
+                continue;
+            }
+            bool cached;
+            float* resampled = output.ring.find(source_row, source_row - 1, cached);
+            resample_row(source, output.columns, source_row, 0, output.destination.width, output.interleaved, resampled);
+            for (; y < output.destination.height && rows.second[y] <= source_row; ++y) {
+                float* top = output.ring.find(rows.first[y], rows.second[y], cached);
+                float* bottom = output.ring.find(rows.second[y], rows.first[y], cached);
+                blend_rows(top, bottom, rows.fraction[y], 0, output.destination.width, output.interleaved, output.destination, y);
+            }
+            output.next_row = y;
+        }
+    }
 }
@@ -0,0 +1,22 @@
+#include "resize_box.h"
+#include "summed_area_table.h"
+#include <cmath>
+
+void resize_box::resize_region(const const_image_view& source, const image_region& region, const image_view& destination) const {
+    image_region clipped = clip_region(source, region, destination);
+
+    // Only the pixels overlapping the region are summed
+    int x0 = static_cast<int>(clipped.x);
+    int y0 = static_cast<int>(clipped.y);
+    int x1 = static_cast<int>(std::ceil(clipped.x + clipped.width));
+    int y1 = static_cast<int>(std::ceil(clipped.y + clipped.height));
+    summed_area_table table(source.crop(x0, y0, x1 - x0, y1 - y0));
+    table.resize_region(image_region{clipped.x - x0, clipped.y - y0, clipped.width, clipped.height}, destination, tiling());
+}
+
+void resize_box::resize_many(const const_image_view& source, const std::vector<image_view>& destinations) const {
+    summed_area_table table(source);
+    for (const image_view& destination : destinations) {
+        table.resize(destination, tiling());
+    }
+}
@@ -0,0 +1,121 @@
+#include "resize_c_api.h"
+#include "resize_job.h"
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+thread_local std::string last_error;
+
+// Set by resize_set_antialiasing for the calling thread
+thread_local bool antialiasing = false;
+
+resize_status fail(resize_status status, const std::string& message) {
+    last_error = message;
+    return status;
+}
+
+const char* method_name(resize_method method) {
+    switch (method) {
+    case RESIZE_NEAREST:
+        return "nearest";
+    case RESIZE_BILINEAR:
+        return "bilinear";
+    case RESIZE_BOX:
+        return "box";
+    case RESIZE_MAX:
+        return "max";
+    case RESIZE_MIN:
+        return "min";
+    case RESIZE_MODE:
+        return "mode";
+    }
+    return "";
+}
+
+// Resizes with the shared resizer of the method, or with one of its own when the calling
+// thread enabled antialiasing
+void resize_with(resize_method method, const const_image_view& source, const image_view& destination) {
+    if (!antialiasing) {
+        resizer_for(method_name(method)).resize(source, destination);
+        return;
+    }
+    std::unique_ptr<resize_image_base> resizer = create_resizer(method_name(method));
+    resizer->set_antialiasing(true);
+    resizer->resize(source, destination);
+}
+
+} // namespace
+
+int resize_api_version(void) {
+    return RESIZE_API_VERSION;
+}
+
+resize_status resize_planar(resize_method method, const unsigned char* source, int width, int height, int spectrum,
+                            unsigned char* destination, int new_width, int new_height) {
+    if (!source || !destination || width <= 0 || height <= 0 || spectrum <= 0 || new_width <= 0 || new_height <= 0) {
+        return fail(RESIZE_INVALID_ARGUMENT, "null buffer or non-positive dimension");
+    }
+    try {
+        // The caller's buffers are read and written in place
+        resize_with(method, const_image_view::planar(source, width, height, spectrum), image_view::planar(destination, new_width, new_height, spectrum));
+        return RESIZE_OK;
+    } catch (const std::invalid_argument& error) {
+        return fail(RESIZE_INVALID_ARGUMENT, error.what());
+    } catch (const std::exception& error) {
+        return fail(RESIZE_INTERNAL_ERROR, error.what());
+    }
+}
+
+resize_status resize_interleaved(resize_method method, const unsigned char* source, int width, int height, int channels, int source_row_stride,
+                                 unsigned char* destination, int new_width, int new_height, int destination_row_stride) {
+    if (!source || !destination || width <= 0 || height <= 0 || channels <= 0 || new_width <= 0 || new_height <= 0) {
+        return fail(RESIZE_INVALID_ARGUMENT, "null buffer or non-positive dimension");
+    }
+    if ((source_row_stride != 0 && source_row_stride < width * channels) || (destination_row_stride != 0 && destination_row_stride < new_width * channels)) {
+        return fail(RESIZE_INVALID_ARGUMENT, "row stride shorter than a row");
+    }
+    try {
+        resize_with(method, const_image_view::interleaved(source, width, height, channels, source_row_stride),
+                    image_view::interleaved(destination, new_width, new_height, channels, destination_row_stride));
+        return RESIZE_OK;
+    } catch (const std::invalid_argument& error) {
+        return fail(RESIZE_INVALID_ARGUMENT, error.what());
+    } catch (const std::exception& error) {
+        return fail(RESIZE_INTERNAL_ERROR, error.what());
+    }
+}
+
+resize_status resize_file(resize_method method, const char* input, const char* output, int new_width, int new_height, int quality) {
+    if (!input || !output) {
+        return fail(RESIZE_INVALID_ARGUMENT, "null path");
+    }
+    resize_job job;
+    job.method = method_name(method);
+    job.input = input;
+    job.output = output;
+    job.width = new_width;
+    job.height = new_height;
+    job.quality = quality;
+    job.antialias = antialiasing;
+    if (new_width < 0 || new_height < 0 || quality < 1 || quality > 100) {
+        return fail(RESIZE_INVALID_ARGUMENT, "negative size or quality outside 1..100");
+    }
+    try {
+        run_job(job);
+        return RESIZE_OK;
+    } catch (const std::invalid_argument& error) {
+        return fail(RESIZE_INVALID_ARGUMENT, error.what());
+    } catch (const std::exception& error) {
+        return fail(RESIZE_IO_ERROR, error.what());
+    }
+}
+
+void resize_set_antialiasing(int enabled) {
+    antialiasing = enabled != 0;
+}
+
+const char* resize_last_error(void) {
+    return last_error.c_str();
+}
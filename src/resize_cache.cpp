@@ -0,0 +1,268 @@
+#include "resize_cache.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const char disk_magic[4] = {'R', 'S', 'Z', 'C'};
+const char* disk_extension = ".rsz";
+
+std::uint64_t mix(std::uint64_t value) {
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ULL;
+    value ^= value >> 33;
+    return value;
+}
+
+std::uint64_t hash_block(std::uint64_t hash, const unsigned char* data, std::size_t size) {
+    // Four independent lanes of 8-byte words keep the multiplier pipelines busy
+    const std::uint64_t prime = 0x9e3779b97f4a7c15ULL;
+    std::uint64_t lanes[4] = {hash, hash ^ prime, hash + prime, hash - prime};
+    std::size_t offset = 0;
+    for (; offset + 32 <= size; offset += 32) {
+        for (int lane = 0; lane < 4; ++lane) {
+            std::uint64_t word;
+            std::memcpy(&word, data + offset + lane * 8, 8);
+            lanes[lane] = (lanes[lane] ^ word) * prime;
+            lanes[lane] ^= lanes[lane] >> 29;
+        }
+    }
+    hash = mix(lanes[0]) ^ mix(lanes[1] + 1) ^ mix(lanes[2] + 2) ^ mix(lanes[3] + 3);
+    for (; offset < size; ++offset) {
+        hash = (hash ^ data[offset]) * prime;
+    }
+    return mix(hash ^ size);
+}
+
+resize_cache::image_ptr read_disk_entry(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    char magic[4];
+    std::int32_t dimensions[3];
+    if (!file.read(magic, 4) || std::memcmp(magic, disk_magic, 4) != 0 || !file.read(reinterpret_cast<char*>(dimensions), sizeof(dimensions))) {
+        return nullptr;
+    }
+    if (dimensions[0] <= 0 || dimensions[1] <= 0 || dimensions[2] <= 0) {
+        return nullptr;
+    }
+
+    // The dimensions must describe exactly the pixels that follow them, so that a corrupt
+    // or truncated entry is rejected before its pixels are allocated
+    std::error_code error;
+    std::uintmax_t file_bytes = fs::file_size(path, error);
+    std::uint64_t header_bytes = 4 + sizeof(dimensions);
+    std::uint64_t row_bytes = static_cast<std::uint64_t>(dimensions[0]) * dimensions[2];
+    if (error || file_bytes < header_bytes) {
+        return nullptr;
+    }
+    std::uint64_t pixel_bytes = file_bytes - header_bytes;
+    if (pixel_bytes % row_bytes != 0 || pixel_bytes / row_bytes != static_cast<std::uint64_t>(dimensions[1])) {
+        return nullptr;
+    }
+    auto image = std::make_shared<cimg_library::CImg<unsigned char>>(dimensions[0], dimensions[1], 1, dimensions[2]);
+    if (!file.read(reinterpret_cast<char*>(image->data()), image->size())) {
+        return nullptr;
+    }
+    return image;
+}
+
+bool write_disk_entry(const std::string& path, const cimg_library::CImg<unsigned char>& image) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    std::int32_t dimensions[3] = {image.width(), image.height(), image.spectrum()};
+    file.write(disk_magic, 4);
+    file.write(reinterpret_cast<const char*>(dimensions), sizeof(dimensions));
+    file.write(reinterpret_cast<const char*>(image.data()), image.size());
+    return static_cast<bool>(file);
+}
+
+std::size_t disk_entry_bytes(const cimg_library::CImg<unsigned char>& image) {
+    return 4 + 3 * sizeof(std::int32_t) + image.size();
+}
+
+} // namespace
+
+resize_cache::resize_cache(std::size_t memory_budget, const std::string& disk_directory, std::size_t disk_budget)
+    : memory_budget_(memory_budget), disk_directory_(disk_directory), disk_budget_(disk_budget) {
+    if (disk_directory_.empty()) {
+        return;
+    }
+    fs::create_directories(disk_directory_);
+
+    // Index the entries left by previous runs, most recently used first
+    std::vector<std::pair<fs::file_time_type, fs::directory_entry>> entries;
+    for (const fs::directory_entry& entry : fs::directory_iterator(disk_directory_)) {
+        if (entry.is_regular_file() && entry.path().extension() == disk_extension) {
+            entries.emplace_back(entry.last_write_time(), entry);
+        }
+    }
+    std::sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+    for (const auto& entry : entries) {
+        std::string key = entry.second.path().stem().string();
+        disk_lru_.push_back(key);
+        disk_index_[key] = disk_entry{static_cast<std::size_t>(entry.second.file_size()), std::prev(disk_lru_.end())};
+        stats_.disk_bytes += entry.second.file_size();
+    }
+    while (stats_.disk_bytes > disk_budget_ && !disk_lru_.empty()) {
+        std::string key = disk_lru_.back();
+        std::error_code ignored;
+        fs::remove(disk_path(key), ignored);
+        stats_.disk_bytes -= disk_index_[key].bytes;
+        disk_index_.erase(key);
+        disk_lru_.pop_back();
+    }
+}
+
+std::uint64_t resize_cache::hash_bytes(const void* data, std::size_t size) {
+    return hash_block(0, static_cast<const unsigned char*>(data), size);
+}
+
+std::uint64_t resize_cache::hash_file(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("cannot read " + path);
+    }
+    std::vector<unsigned char> buffer(1 << 20);
+    std::uint64_t hash = 0;
+    std::size_t total = 0;
+    while (file) {
+        file.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+        std::size_t count = file.gcount();
+        hash = hash_block(hash, buffer.data(), count);
+        total += count;
+    }
+    return mix(hash ^ total);
+}
+
+std::string resize_cache::make_key(std::uint64_t content_hash, const std::string& parameters) {
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(content_hash));
+    return std::string(hex) + "_" + parameters;
+}
+
+resize_cache::image_ptr resize_cache::lookup(const std::string& key) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto found = memory_index_.find(key);
+        if (found != memory_index_.end()) {
+            memory_lru_.splice(memory_lru_.begin(), memory_lru_, found->second);
+            ++stats_.memory_hits;
+            return found->second->image;
+        }
+        if (disk_index_.count(key) == 0) {
+            ++stats_.misses;
+            return nullptr;
+        }
+    }
+
+    // Read outside the lock; an entry evicted meanwhile just fails to read
+    image_ptr image = read_disk_entry(disk_path(key));
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!image) {
+        ++stats_.misses;
+        return nullptr;
+    }
+    ++stats_.disk_hits;
+    touch_on_disk(key);
+    store_in_memory(key, image);
+    return image;
+}
+
+void resize_cache::store(const std::string& key, const cimg_library::CImg<unsigned char>& image) {
+    // Deep copy, the image may be a shared view over someone else's memory
+    image_ptr shared = std::make_shared<const cimg_library::CImg<unsigned char>>(image, false);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        store_in_memory(key, shared);
+    }
+    std::size_t bytes = disk_entry_bytes(image);
+    if (disk_directory_.empty() || bytes > disk_budget_) {
+        return;
+    }
+
+    // Write under a unique temporary name, then publish the entry atomically
+    static std::atomic<unsigned> temporary_counter(0);
+    std::string path = disk_path(key);
+    std::string temporary_path = path + ".tmp" + std::to_string(temporary_counter++);
+    if (!write_disk_entry(temporary_path, image)) {
+        std::error_code ignored;
+        fs::remove(temporary_path, ignored);
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::error_code error;
+    fs::rename(temporary_path, path, error);
+    if (error) {
+        fs::remove(temporary_path, error);
+        return;
+    }
+    auto found = disk_index_.find(key);
+    if (found != disk_index_.end()) {
+        stats_.disk_bytes -= found->second.bytes;
+        disk_lru_.erase(found->second.position);
+        disk_index_.erase(found);
+    }
+    disk_lru_.push_front(key);
+    disk_index_[key] = disk_entry{bytes, disk_lru_.begin()};
+    stats_.disk_bytes += bytes;
+
+    while (stats_.disk_bytes > disk_budget_) {
+        std::string evicted = disk_lru_.back();
+        fs::remove(disk_path(evicted), error);
+        stats_.disk_bytes -= disk_index_[evicted].bytes;
+        disk_index_.erase(evicted);
+        disk_lru_.pop_back();
+    }
+}
+
+resize_cache_stats resize_cache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void resize_cache::store_in_memory(const std::string& key, image_ptr image) {
+    if (image->size() > memory_budget_) {
+        return;
+    }
+    auto found = memory_index_.find(key);
+    if (found != memory_index_.end()) {
+        stats_.memory_bytes -= found->second->image->size();
+        memory_lru_.erase(found->second);
+        memory_index_.erase(found);
+    }
+    memory_lru_.push_front(memory_entry{key, image});
+    memory_index_[key] = memory_lru_.begin();
+    stats_.memory_bytes += image->size();
+
+    while (stats_.memory_bytes > memory_budget_) {
+        const memory_entry& evicted = memory_lru_.back();
+        stats_.memory_bytes -= evicted.image->size();
+        memory_index_.erase(evicted.key);
+        memory_lru_.pop_back();
+    }
+}
+
+void resize_cache::touch_on_disk(const std::string& key) {
+    auto found = disk_index_.find(key);
+    if (found == disk_index_.end()) {
+        return;
+    }
+    disk_lru_.splice(disk_lru_.begin(), disk_lru_, found->second.position);
+
+    // Keep the modification time in LRU order so that it survives a restart
+    std::error_code ignored;
+    fs::last_write_time(disk_path(key), fs::file_time_type::clock::now(), ignored);
+}
+
+std::string resize_cache::disk_path(const std::string& key) const {
+    return (fs::path(disk_directory_) / (key + disk_extension)).string();
+}
@@ -0,0 +1,111 @@
+#include "resize_client.h"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace resize_protocol;
+
+resize_client::resize_client(const std::string& socket_path) : socket_(-1) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("socket path too long: " + socket_path);
+    }
+    std::strcpy(address.sun_path, socket_path.c_str());
+
+    socket_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (socket_ < 0 || connect(socket_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        int error = errno;
+        if (socket_ >= 0) {
+            close(socket_);
+        }
+        throw std::runtime_error("cannot connect to " + socket_path + ": " + std::strerror(error));
+    }
+}
+
+resize_client::~resize_client() {
+    close(socket_);
+}
+
+shared_image resize_client::resize(const shared_image& source, const std::string& method, int new_width, int new_height) {
+    payload_writer fields;
+    fields.put_string(method);
+    fields.put_int(new_width);
+    fields.put_int(new_height);
+    fields.put_int(source.width());
+    fields.put_int(source.height());
+    fields.put_int(source.spectrum());
+
+    frame response = request(resize_shared, fields.data(), source.fd());
+    payload_reader reply(response.payload);
+    reply.get_int();
+    int width = reply.get_int();
+    int height = reply.get_int();
+    int spectrum = reply.get_int();
+    return shared_image::adopt(response.fd, width, height, spectrum, false);
+}
+
+image_size resize_client::resize_file(const resize_job& job) {
+    if (job.output.empty()) {
+        throw std::runtime_error("resize_file needs an output path");
+    }
+    image_size size;
+    send_resize_file(job, job.output, size);
+    return size;
+}
+
+shared_image resize_client::load_resized(const resize_job& job) {
+    image_size size;
+    return send_resize_file(job, "", size);
+}
+
+shared_image resize_client::send_resize_file(const resize_job& job, const std::string& output, image_size& size) {
+    payload_writer fields;
+    fields.put_int(job.width);
+    fields.put_int(job.height);
+    fields.put_float(job.scale);
+    fields.put_int(job.quality);
+    fields.put_int(job.keep_grey ? 1 : 0);
+    fields.put_int(job.antialias ? 1 : 0);
+    fields.put_string(job.method);
+    fields.put_string(job.input);
+    fields.put_string(output);
+
+    frame response = request(resize_protocol::resize_file, fields.data(), -1);
+    payload_reader reply(response.payload);
+    reply.get_int();
+    size.width = reply.get_int();
+    size.height = reply.get_int();
+    int spectrum = reply.get_int();
+    if (response.fd < 0) {
+        return shared_image();
+    }
+    return shared_image::adopt(response.fd, size.width, size.height, spectrum, false);
+}
+
+frame resize_client::request(std::uint16_t type, const std::vector<unsigned char>& payload, int fd) {
+    frame response;
+    if (!send_frame(socket_, type, payload, fd) || !receive_frame(socket_, response) || response.type != reply) {
+        if (response.fd >= 0) {
+            close(response.fd);
+        }
+        throw std::runtime_error("lost connection to the resize service");
+    }
+
+    payload_reader reply(response.payload);
+    std::int32_t status = reply.get_int();
+    reply.get_int();
+    reply.get_int();
+    reply.get_int();
+    std::string message = reply.get_string();
+    if (status != 0) {
+        if (response.fd >= 0) {
+            close(response.fd);
+        }
+        throw std::runtime_error(message);
+    }
+    return response;
+}
@@ -0,0 +1,148 @@
+#include "resize_exact.h"
+#include "kernel_dispatch.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Takes every other pixel of a source row starting at the region, for the destination
+// columns [x_begin, x_end); channels is the number of interleaved channels per pixel
+template<int channels>
+inline void halve_pixels(const unsigned char* source_row, int x_begin, int x_end, unsigned char* destination_row) {
+    for (int x = x_begin; x < x_end; ++x) {
+        for (int c = 0; c < channels; ++c) {
+            destination_row[x * channels + c] = source_row[2 * x * channels + c];
+        }
+    }
+}
+
+// Destination column x of a doubling: the floored average of source columns x / 2 and,
+// on odd columns, the next one, both taken from the top and bottom source rows
+template<int channels>
+inline void double_pixel(const unsigned char* top, const unsigned char* bottom, int last, int x, unsigned char* destination_row) {
+    int left = x >> 1;
+    int right = std::min(left + (x & 1), last);
+    for (int c = 0; c < channels; ++c) {
+        int sum = top[left * channels + c] + top[right * channels + c] + bottom[left * channels + c] + bottom[right * channels + c];
+        destination_row[x * channels + c] = static_cast<unsigned char>(sum >> 2);
+    }
+}
+
+// Doubles the columns [x_begin, x_end) of a destination row from the source rows top and
+// bottom, starting at the region; last is the last source column relative to the region.
+// Even rows pass the same source row twice.
+template<int channels>
+inline void double_pixels(const unsigned char* top, const unsigned char* bottom, int last, int x_begin, int x_end, unsigned char* destination_row) {
+    int x = x_begin;
+    if (x < x_end && (x & 1)) {
+        double_pixel<channels>(top, bottom, last, x, destination_row);
+        ++x;
+    }
+    // Pairs of columns whose source columns both lie inside the region
+    int pairs_end = std::min(x_end / 2, last);
+    for (int left = x >> 1; left < pairs_end; ++left) {
+        for (int c = 0; c < channels; ++c) {
+            int a = top[left * channels + c];
+            int b = top[(left + 1) * channels + c];
+            int d = bottom[left * channels + c];
+            int e = bottom[(left + 1) * channels + c];
+            destination_row[2 * left * channels + c] = static_cast<unsigned char>((a + d) >> 1);
+            destination_row[(2 * left + 1) * channels + c] = static_cast<unsigned char>((a + b + d + e) >> 2);
+        }
+    }
+    x = std::max(x, 2 * pairs_end);
+    for (; x < x_end; ++x) {
+        double_pixel<channels>(top, bottom, last, x, destination_row);
+    }
+}
+
+RESIZE_KERNEL_CLONES
+void halve_row(const const_image_view& source, int x0, int source_row, int x_begin, int x_end, const image_view& destination, int y) {
+    if (source.has_contiguous_pixels() && destination.has_contiguous_pixels()) {
+        const unsigned char* row = source.row(source_row, 0) + static_cast<std::ptrdiff_t>(x0) * source.spectrum;
+        unsigned char* result = destination.row(y, 0);
+        switch (source.spectrum) {
+        case 1:
+            halve_pixels<1>(row, x_begin, x_end, result);
+            return;
+        case 3:
+            halve_pixels<3>(row, x_begin, x_end, result);
+            return;
+        case 4:
+            halve_pixels<4>(row, x_begin, x_end, result);
+            return;
+        }
+    }
+    if (source.has_contiguous_rows() && destination.has_contiguous_rows()) {
+        for (int c = 0; c < source.spectrum; ++c) {
+            halve_pixels<1>(source.row(source_row, c) + x0, x_begin, x_end, destination.row(y, c));
+        }
+        return;
+    }
+    for (int c = 0; c < source.spectrum; ++c) {
+        for (int x = x_begin; x < x_end; ++x) {
+            destination(x, y, c) = source(x0 + 2 * x, source_row, c);
+        }
+    }
+}
+
+RESIZE_KERNEL_CLONES
+void double_row(const const_image_view& source, int x0, int x_last, int top_row, int bottom_row, int x_begin, int x_end, const image_view& destination, int y) {
+    int last = x_last - x0;
+    if (source.has_contiguous_pixels() && destination.has_contiguous_pixels()) {
+        std::ptrdiff_t offset = static_cast<std::ptrdiff_t>(x0) * source.spectrum;
+        const unsigned char* top = source.row(top_row, 0) + offset;
+        const unsigned char* bottom = source.row(bottom_row, 0) + offset;
+        unsigned char* result = destination.row(y, 0);
+        switch (source.spectrum) {
+        case 1:
+            double_pixels<1>(top, bottom, last, x_begin, x_end, result);
+            return;
+        case 3:
+            double_pixels<3>(top, bottom, last, x_begin, x_end, result);
+            return;
+        case 4:
+            double_pixels<4>(top, bottom, last, x_begin, x_end, result);
+            return;
+        }
+    }
+    if (source.has_contiguous_rows() && destination.has_contiguous_rows()) {
+        for (int c = 0; c < source.spectrum; ++c) {
+            double_pixels<1>(source.row(top_row, c) + x0, source.row(bottom_row, c) + x0, last, x_begin, x_end, destination.row(y, c));
+        }
+        return;
+    }
+    for (int c = 0; c < source.spectrum; ++c) {
+        for (int x = x_begin; x < x_end; ++x) {
+            int left = x0 + (x >> 1);
+            int right = std::min(left + (x & 1), x_last);
+            int sum = source(left, top_row, c) + source(right, top_row, c) + source(left, bottom_row, c) + source(right, bottom_row, c);
+            destination(x, y, c) = static_cast<unsigned char>(sum >> 2);
+        }
+    }
+}
+
+} // namespace
+
+exact_ratio detect_exact_ratio(const image_region& region, float x_ratio, float y_ratio) {
+    if (region.x != std::floor(region.x) || region.y != std::floor(region.y)) {
+        return exact_ratio::none;
+    }
+    if (x_ratio == 2.0f && y_ratio == 2.0f) {
+        return exact_ratio::half;
+    }
+    if (x_ratio == 0.5f && y_ratio == 0.5f) {
+        return exact_ratio::twice;
+    }
+    return exact_ratio::none;
+}
+
+void halve_span(const const_image_view& source, int x0, int y0, int y, int x_begin, int x_end, const image_view& destination) {
+    halve_row(source, x0, y0 + 2 * y, x_begin, x_end, destination, y);
+}
+
+void double_span(const const_image_view& source, int x0, int y0, int x_last, int y_last, int y, int x_begin, int x_end, const image_view& destination) {
+    int top_row = y0 + (y >> 1);
+    int bottom_row = std::min(top_row + (y & 1), y_last);
+    double_row(source, x0, x_last, top_row, bottom_row, x_begin, x_end, destination, y);
+}
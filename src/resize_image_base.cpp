@@ -0,0 +1,118 @@
+#include "resize_image_base.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+// Coordinates this far outside the source still count as inside, so that transforms
+// built from trigonometric functions don't lose an edge row to rounding
+const double coordinate_tolerance = 1e-6;
+
+// Interior samples are taken in float, which rounds a coordinate to within a relative
+// 2^-24 of it. The interior stops this much further from the last column and row, so that
+// no coordinate just under them rounds onto them and reaches one pixel past the source.
+const double float_rounding_margin = 1.0 / (1 << 23);
+
+// Restricts [begin, end) to the destination columns whose coordinate start + step * x
+// lies within [0, limit). Returns false if no column does.
+bool clip_span(double start, double step, double limit, int& begin, int& end) {
+    start += coordinate_tolerance;
+    if (step == 0.0) {
+        return start >= 0.0 && start < limit;
+    }
+    double first;
+    double last;
+    if (step > 0.0) {
+        first = std::ceil(-start / step);
+        last = std::ceil((limit - start) / step) - 1;
+    } else {
+        first = std::floor((limit - start) / step) + 1;
+        last = std::floor(-start / step);
+    }
+    // Clamp and compare in floating point first so that nearly parallel rows cannot overflow int
+    double clipped_begin = std::max(first, static_cast<double>(begin));
+    double clipped_end = std::min(last + 1, static_cast<double>(end));
+    if (clipped_begin >= clipped_end) {
+        return false;
+    }
+    begin = static_cast<int>(clipped_begin);
+    end = static_cast<int>(clipped_end);
+    return true;
+}
+
+} // namespace
+
+const_image_view resize_image_base::prefiltered_source(const const_image_view& source, image_region& region, const image_view& destination, gaussian_prefilter& prefilter) const {
+    float x_ratio = region.width / destination.width;
+    float y_ratio = region.height / destination.height;
+    if (!antialiasing_ || (x_ratio <= 2.0f && y_ratio <= 2.0f)) {
+        return source;
+    }
+    int x0 = static_cast<int>(region.x);
+    int y0 = static_cast<int>(region.y);
+    int x1 = static_cast<int>(std::ceil(region.x + region.width));
+    int y1 = static_cast<int>(std::ceil(region.y + region.height));
+    region.x -= x0;
+    region.y -= y0;
+    return prefilter.apply(source, x0, y0, x1 - x0, y1 - y0, gaussian_prefilter::sigma_for(x_ratio), gaussian_prefilter::sigma_for(y_ratio));
+}
+
+void resize_image_base::resize_many(const const_image_view& source, const std::vector<image_view>& destinations) const {
+    for (const image_view& destination : destinations) {
+        resize(source, destination);
+    }
+}
+
+void resize_image_base::warp(const const_image_view& source, const affine_transform& transform, const image_view& destination) const {
+    if (destination.spectrum != source.spectrum) {
+        throw std::invalid_argument("destination spectrum does not match the source image");
+    }
+
+    // Each destination pixel covers about the length of a transformed unit vector in the source
+    float x_ratio = static_cast<float>(std::hypot(transform.xx, transform.yx));
+    float y_ratio = static_cast<float>(std::hypot(transform.xy, transform.yy));
+    std::vector<image_tile> tiles = plan_tiles(destination.width, destination.height, source.spectrum, x_ratio, y_ratio, tiling_);
+    for_each_tile(tiles, tiling_.thread_count, [&](const image_tile& tile) {
+        for (int y = tile.y; y < tile.y + tile.height; ++y) {
+            // Source coordinates of the first pixel of the row
+            double row_x = transform.xy * y + transform.x0;
+            double row_y = transform.yy * y + transform.y0;
+
+            // Clamping leaves the columns mapping outside the source untouched, the other edge
+            // modes sample the whole span of the tile
+            int begin = tile.x;
+            int end = tile.x + tile.width;
+            if (edges_ == edge_mode::clamp && (!clip_span(row_x, transform.xx, source.width, begin, end) || !clip_span(row_y, transform.yx, source.height, begin, end))) {
+                continue;
+            }
+
+            // Columns whose taps, up to one pixel right of and below the sample, all lie inside
+            int inside_begin = begin;
+            int inside_end = end;
+            double x_limit = (source.width - 1) * (1.0 - float_rounding_margin);
+            double y_limit = (source.height - 1) * (1.0 - float_rounding_margin);
+            if (!clip_span(row_x, transform.xx, x_limit, inside_begin, inside_end) || !clip_span(row_y, transform.yx, y_limit, inside_begin, inside_end)) {
+                inside_begin = end;
+                inside_end = end;
+            }
+
+            double src_x = row_x + begin * transform.xx;
+            double src_y = row_y + begin * transform.yx;
+            for (int x = begin; x < end; ++x) {
+                if (x == inside_begin) {
+                    warp_inside(source, transform, src_x, src_y, inside_begin, inside_end, destination, y);
+                    x = inside_end;
+                    if (x == end) {
+                        break;
+                    }
+                }
+                for (int c = 0; c < source.spectrum; ++c) {
+                    destination(x, y, c) = estimate_color(source, static_cast<float>(src_x), static_cast<float>(src_y), c, edges_);
+                }
+                src_x += transform.xx;
+                src_y += transform.yx;
+            }
+        }
+    });
+}
@@ -0,0 +1,320 @@
+#include "resize_job.h"
+#include "cimg_adapter.h"
+#include "resize_nearest_neighbour.h"
+#include "resize_bilinear.h"
+#include "resize_box.h"
+#include "resize_reduce.h"
+#include "exif_orientation.h"
+#include "pixel_layout.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+using namespace cimg_library;
+
+namespace {
+
+int parse_int(const std::string& option, const std::string& value) {
+    std::size_t used = 0;
+    int result = 0;
+    try {
+        result = std::stoi(value, &used);
+    } catch (const std::exception&) {
+        used = 0;
+    }
+    if (used == 0 || used != value.size()) {
+        throw std::invalid_argument("invalid value '" + value + "' for " + option);
+    }
+    return result;
+}
+
+float parse_float(const std::string& option, const std::string& value) {
+    std::size_t used = 0;
+    float result = 0;
+    try {
+        result = std::stof(value, &used);
+    } catch (const std::exception&) {
+        used = 0;
+    }
+    if (used == 0 || used != value.size()) {
+        throw std::invalid_argument("invalid value '" + value + "' for " + option);
+    }
+    return result;
+}
+
+std::string lowercase_extension(const std::string& path) {
+    std::string::size_type dot = path.rfind('.');
+    if (dot == std::string::npos) {
+        return std::string();
+    }
+    std::string extension = path.substr(dot + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return std::tolower(c); });
+    return extension;
+}
+
+// Converts a derived output dimension to pixels, rejecting those beyond max_job_dimension
+// before they can overflow an int; NaN fails the comparison as well
+int output_dimension(double size) {
+    if (!(size <= max_job_dimension)) {
+        throw std::invalid_argument("output dimensions are limited to " + std::to_string(max_job_dimension) + " pixels");
+    }
+    return std::max(1, static_cast<int>(size));
+}
+
+// Resizes an image into the destination, rotating it upright in the same pass by writing
+// through a view of the destination in the stored orientation
+void resize_oriented(const resize_image_base& resizer, const const_image_view& source, int orientation, const image_view& destination) {
+    resizer.resize(source, oriented_view(destination, orientation));
+}
+
+} // namespace
+
+std::unique_ptr<resize_image_base> create_resizer(const std::string& method, const tile_options& tiling) {
+    std::unique_ptr<resize_image_base> resizer;
+    if (method == "nearest") {
+        resizer.reset(new resize_nearest_neighbour());
+    } else if (method == "bilinear") {
+        resizer.reset(new resize_bilinear());
+    } else if (method == "box") {
+        resizer.reset(new resize_box());
+    } else if (method == "max") {
+        resizer.reset(new resize_reduce(reduction::max));
+    } else if (method == "min") {
+        resizer.reset(new resize_reduce(reduction::min));
+    } else if (method == "mode") {
+        resizer.reset(new resize_reduce(reduction::mode));
+    } else {
+        throw std::invalid_argument("unknown resize method '" + method + "'");
+    }
+    resizer->set_tiling(tiling);
+    return resizer;
+}
+
+const resize_image_base& resizer_for(const std::string& method) {
+    static const std::map<std::string, std::unique_ptr<resize_image_base>> shared_resizers = []() {
+        std::map<std::string, std::unique_ptr<resize_image_base>> resizers;
+        for (const char* name : {"nearest", "bilinear", "box", "max", "min", "mode"}) {
+            resizers[name] = create_resizer(name);
+        }
+        return resizers;
+    }();
+    auto found = shared_resizers.find(method);
+    if (found == shared_resizers.end()) {
+        throw std::invalid_argument("unknown resize method '" + method + "'");
+    }
+    return *found->second;
+}
+
+image_size job_output_size(const resize_job& job, int source_width, int source_height) {
+    if (job.width > 0 && job.height > 0) {
+        return image_size{job.width, job.height};
+    }
+    if (job.width > 0) {
+        return image_size{job.width, output_dimension(static_cast<double>(static_cast<long long>(source_height) * job.width / source_width))};
+    }
+    if (job.height > 0) {
+        return image_size{output_dimension(static_cast<double>(static_cast<long long>(source_width) * job.height / source_height)), job.height};
+    }
+    return image_size{output_dimension(source_width * job.scale), output_dimension(source_height * job.scale)};
+}
+
+void validate_job(const resize_job& job) {
+    resizer_for(job.method);
+    if (job.width < 0 || job.height < 0 || job.width > max_job_dimension || job.height > max_job_dimension) {
+        throw std::invalid_argument("width and height must be between 0 and " + std::to_string(max_job_dimension));
+    }
+    if (!std::isfinite(job.scale) || job.scale <= 0) {
+        throw std::invalid_argument("scale must be a finite positive number");
+    }
+    if (job.quality < 1 || job.quality > 100) {
+        throw std::invalid_argument("quality must be between 1 and 100");
+    }
+    if (job.tile_threads < 1 || job.tile_threads > max_tile_threads) {
+        throw std::invalid_argument("tile threads must be between 1 and " + std::to_string(max_tile_threads));
+    }
+}
+
+resize_job parse_job_arguments(const std::vector<std::string>& args, resize_job job) {
+    std::vector<std::string> paths;
+    for (std::size_t i = 0; i < args.size(); ++i) {
+        const std::string& arg = args[i];
+        if (arg.compare(0, 2, "--") != 0) {
+            paths.push_back(arg);
+            continue;
+        }
+        if (arg == "--antialias") {
+            job.antialias = true;
+            continue;
+        }
+        if (i + 1 == args.size()) {
+            throw std::invalid_argument("missing value for " + arg);
+        }
+        const std::string& value = args[++i];
+        if (arg == "--method") {
+            resizer_for(value);
+            job.method = value;
+        } else if (arg == "--width") {
+            job.width = parse_int(arg, value);
+        } else if (arg == "--height") {
+            job.height = parse_int(arg, value);
+        } else if (arg == "--scale") {
+            job.scale = parse_float(arg, value);
+        } else if (arg == "--quality") {
+            job.quality = parse_int(arg, value);
+        } else if (arg == "--grey") {
+            if (value != "expand" && value != "keep") {
+                throw std::invalid_argument("--grey expects expand or keep");
+            }
+            job.keep_grey = value == "keep";
+        } else if (arg == "--tile-threads") {
+            job.tile_threads = parse_int(arg, value);
+        } else {
+            throw std::invalid_argument("unknown option " + arg);
+        }
+    }
+
+    validate_job(job);
+    if (paths.size() > 2) {
+        throw std::invalid_argument("unexpected argument " + paths[2]);
+    }
+    if (paths.size() > 0) {
+        job.input = paths[0];
+    }
+    if (paths.size() > 1) {
+        job.output = paths[1];
+    }
+    return job;
+}
+
+std::vector<resize_job> read_manifest(const std::string& path, const resize_job& defaults) {
+    std::ifstream manifest(path);
+    if (!manifest) {
+        throw std::runtime_error("cannot read manifest " + path);
+    }
+
+    std::vector<resize_job> jobs;
+    std::string line;
+    int line_number = 0;
+    while (std::getline(manifest, line)) {
+        ++line_number;
+        std::istringstream tokens(line);
+        std::vector<std::string> args;
+        std::string token;
+        while (tokens >> token) {
+            args.push_back(token);
+        }
+        if (args.empty() || args[0][0] == '#') {
+            continue;
+        }
+        try {
+            jobs.push_back(parse_job_arguments(args, defaults));
+        } catch (const std::invalid_argument& error) {
+            throw std::invalid_argument(path + ":" + std::to_string(line_number) + ": " + error.what());
+        }
+        if (jobs.back().output.empty()) {
+            throw std::invalid_argument(path + ":" + std::to_string(line_number) + ": expected an input and an output path");
+        }
+    }
+    return jobs;
+}
+
+job_input open_job_input(const resize_job& job) {
+    if (job.input.empty()) {
+        throw std::invalid_argument("a job needs an input path");
+    }
+    job_input input;
+    input.mapped = mapped_image::open(job.input);
+    if (!input.mapped.empty()) {
+        input.pixels = input.mapped.view();
+    } else {
+        input.decoded.load(job.input.c_str());
+        input.pixels = view_of(input.decoded);
+        input.orientation = read_exif_orientation(job.input);
+    }
+    // Interleaved images resize faster as colour than from their strided first channel
+    if (input.pixels.spectrum == 3 && (input.pixels.has_contiguous_rows() || job.keep_grey)) {
+        input.grey = is_grey(input.pixels);
+    }
+    return input;
+}
+
+image_size job_output_size(const resize_job& job, const job_input& input) {
+    bool swap = orientation_swaps_axes(input.orientation);
+    return job_output_size(job, swap ? input.pixels.height : input.pixels.width, swap ? input.pixels.width : input.pixels.height);
+}
+
+int job_output_spectrum(const resize_job& job, const job_input& input) {
+    return input.grey && job.keep_grey ? 1 : input.pixels.spectrum;
+}
+
+void resize_job_into(const resize_job& job, const job_input& input, const image_view& destination) {
+    std::unique_ptr<resize_image_base> job_resizer = create_resizer(job.method, tile_options{0, job.tile_threads});
+    job_resizer->set_antialiasing(job.antialias);
+    const resize_image_base& resizer = *job_resizer;
+    if (input.grey && (destination.spectrum == 1 || input.pixels.has_contiguous_rows())) {
+        // Grey inputs are resized once, from their first channel
+        resize_oriented(resizer, input.pixels.channel(0), input.orientation, destination.channel(0));
+        if (destination.spectrum > 1) {
+            broadcast_grey(destination);
+        }
+    } else if (input.orientation == 1 && input.pixels.spectrum > 1 && input.pixels.has_contiguous_pixels() && !destination.has_contiguous_pixels()) {
+        // Interleaved inputs resize fastest into their own layout, converted in one pass after
+        std::vector<unsigned char> interleaved(static_cast<std::size_t>(destination.width) * destination.height * destination.spectrum);
+        image_view resized = image_view::interleaved(interleaved.data(), destination.width, destination.height, destination.spectrum);
+        resizer.resize(input.pixels, resized);
+        copy_pixels(resized, destination);
+    } else {
+        resize_oriented(resizer, input.pixels, input.orientation, destination);
+    }
+}
+
+void save_job_output(const resize_job& job, const cimg_library::CImg<unsigned char>& image) {
+    std::string extension = lowercase_extension(job.output);
+    if (extension == "jpg" || extension == "jpeg") {
+        image.save_jpeg(job.output.c_str(), job.quality);
+    } else if ((extension == "ppm" || extension == "pgm" || extension == "pnm") && (image.spectrum() == 1 || image.spectrum() == 3)) {
+        save_pnm(image, job.output);
+    } else {
+        image.save(job.output.c_str());
+    }
+}
+
+std::string job_cache_key(const resize_job& job) {
+    // 9 significant digits tell every pair of distinct floats apart
+    std::ostringstream parameters;
+    parameters << std::setprecision(9) << job.method << "_w" << job.width << "_h" << job.height << "_s" << job.scale << (job.keep_grey ? "_grey" : "") << (job.antialias ? "_aa" : "");
+    return resize_cache::make_key(resize_cache::hash_file(job.input), parameters.str());
+}
+
+image_size run_job(const resize_job& job, resize_cache* cache) {
+    if (job.output.empty()) {
+        throw std::invalid_argument("a job needs an input and an output path");
+    }
+    resizer_for(job.method);
+
+    std::string key;
+    if (cache) {
+        key = job_cache_key(job);
+        if (resize_cache::image_ptr cached = cache->lookup(key)) {
+            save_job_output(job, *cached);
+            return image_size{cached->width(), cached->height()};
+        }
+    }
+
+    // Open the image, then resize it, rotating it upright in the same pass
+    job_input input = open_job_input(job);
+    image_size size = job_output_size(job, input);
+    CImg<unsigned char> resized_image(size.width, size.height, 1, job_output_spectrum(job, input), 0);
+    resize_job_into(job, input, view_of(resized_image));
+    if (cache) {
+        cache->store(key, resized_image);
+    }
+
+    save_job_output(job, resized_image);
+    return size;
+}
@@ -1,33 +1,300 @@
 #include "resize_nearest_neighbour.h"
+#include "resize_kernels.h"
+#include "kernel_dispatch.h"
+#include "resize_tiles.h"
+#include "resize_exact.h"
 #include <algorithm>
 #include <cmath>
-#include <iostream>
+#include <cstring>
+#include <vector>
 
-using namespace cimg_library;
+namespace {
 
-cimg_library::CImg<unsigned char> resize_nearest_neighbour::resize(const cimg_library::CImg<unsigned char>& source, int new_width, int new_height) const {
-    cimg_library::CImg<unsigned char> result(new_width, new_height, 1, source.spectrum(), 0);
-    float x_ratio = static_cast<float>(source.width()) / new_width;
-    float y_ratio = static_cast<float>(source.height()) / new_height;
+// Fills the columns [x_begin, x_end) of one destination row when the source and destination
+// pixels are interleaved; the channel count is a constant, so each pixel is one short copy
+template<int channels>
+inline void nearest_pixels(const resize_kernels::axis_table& columns, const unsigned char* source_row, int x_begin, int x_end, unsigned char* destination_row) {
+    for (int x = x_begin; x < x_end; ++x) {
+        const unsigned char* sample = source_row + static_cast<std::ptrdiff_t>(columns.first[x]) * channels;
+        unsigned char* pixel = destination_row + static_cast<std::ptrdiff_t>(x) * channels;
+        for (int c = 0; c < channels; ++c) {
+            pixel[c] = sample[c];
+        }
+    }
+}
+
+// Fills the columns [x_begin, x_end) of one destination row from the coefficient tables,
+// cloned per instruction set level
+RESIZE_KERNEL_CLONES
+void nearest_span(const const_image_view& source, const resize_kernels::axis_table& columns, const resize_kernels::axis_table& rows, int y, int x_begin, int x_end, const image_view& destination) {
+    int source_y = rows.first[y];
+    if (source.has_contiguous_pixels() && destination.has_contiguous_pixels()) {
+        const unsigned char* source_row = source.row(source_y, 0);
+        unsigned char* destination_row = destination.row(y, 0);
+        switch (source.spectrum) {
+        case 1:
+            nearest_pixels<1>(columns, source_row, x_begin, x_end, destination_row);
+            return;
+        case 3:
+            nearest_pixels<3>(columns, source_row, x_begin, x_end, destination_row);
+            return;
+        case 4:
+            nearest_pixels<4>(columns, source_row, x_begin, x_end, destination_row);
+            return;
+        }
+    }
+    for (int c = 0; c < source.spectrum; ++c) {
+        for (int x = x_begin; x < x_end; ++x) {
+            destination(x, y, c) = source(columns.first[x], source_y, c);
+        }
+    }
+}
+
+// Returns the factor k when a table replicates each source index of the region k times, as
+// an integer upscale does, and 0 otherwise. round() puts the halfway samples of even factors
+// on the next index, so the first index covers ceil(k / 2) samples and the last the rest.
+// Only the factors with a replication kernel are reported.
+int replication_factor(const resize_kernels::axis_table& table) {
+    int count = static_cast<int>(table.first.size());
+    int start = table.first.front();
+    int span = table.first.back() - start + 1;
+    if (count % span != 0 || count / span < 2 || count / span > 4) {
+        return 0;
+    }
+    int factor = count / span;
+    int first_run = (factor + 1) / 2;
+    for (int i = 0; i < count; ++i) {
+        if (table.first[i] != start + std::min((i + factor - first_run) / factor, span - 1)) {
+            return 0;
+        }
+    }
+    return factor;
+}
 
-    for (int y = 0; y < new_height; ++y) {
-        for (int x = 0; x < new_width; ++x) {
-            for (int c = 0; c < source.spectrum(); ++c) {
-                float src_x = x * x_ratio;
-                float src_y = y * y_ratio;
-                result(x, y, 0, c) = estimate_color(source, src_x, src_y, c);
+// Fills the columns [x_begin, x_end) of one destination row of an integer upscale by
+// replicating the pixels of source_row, which starts at the region; last is the last
+// source pixel of the region. The runs of factor copies of the interior pixels are
+// constant-size stores, the partial runs at the ends of the span and the first and last
+// pixels of the region go one pixel at a time.
+template<int factor, int channels>
+inline void replicate_pixels(const unsigned char* source_row, int last, int x_begin, int x_end, unsigned char* destination_row) {
+    const int first_run = (factor + 1) / 2;
+    // Interior source pixels s, in [1, last), whose run [first_run + (s - 1) * factor, first_run + s * factor) lies in the span
+    int run_begin = x_begin <= first_run ? 1 : (x_begin - first_run + factor - 1) / factor + 1;
+    int run_end = x_end < first_run ? 1 : std::min(last, (x_end - first_run) / factor + 1);
+    run_end = std::max(run_begin, run_end);
+    int runs_x = first_run + (run_begin - 1) * factor;
+    int runs_x_end = first_run + (run_end - 1) * factor;
+
+    auto replicate_pixel = [&](int x) {
+        const unsigned char* sample = source_row + static_cast<std::ptrdiff_t>(std::min((x + factor - first_run) / factor, last)) * channels;
+        for (int c = 0; c < channels; ++c) {
+            destination_row[static_cast<std::ptrdiff_t>(x) * channels + c] = sample[c];
+        }
+    };
+    for (int x = x_begin; x < std::min(x_end, runs_x); ++x) {
+        replicate_pixel(x);
+    }
+    for (int s = run_begin; s < run_end; ++s) {
+        unsigned char* run = destination_row + static_cast<std::ptrdiff_t>(first_run + (s - 1) * factor) * channels;
+        for (int j = 0; j < factor; ++j) {
+            for (int c = 0; c < channels; ++c) {
+                run[j * channels + c] = source_row[s * channels + c];
             }
         }
     }
+    for (int x = std::max(x_begin, runs_x_end); x < x_end; ++x) {
+        replicate_pixel(x);
+    }
+}
+
+template<int channels>
+inline void replicate_row(int factor, const unsigned char* source_row, int last, int x_begin, int x_end, unsigned char* destination_row) {
+    switch (factor) {
+    case 2:
+        replicate_pixels<2, channels>(source_row, last, x_begin, x_end, destination_row);
+        return;
+    case 3:
+        replicate_pixels<3, channels>(source_row, last, x_begin, x_end, destination_row);
+        return;
+    default:
+        replicate_pixels<4, channels>(source_row, last, x_begin, x_end, destination_row);
+        return;
+    }
+}
+
+// Fills the columns [x_begin, x_end) of one destination row of an integer upscale by the
+// given replication factor, when the pixels or rows of both images are contiguous. Returns
+// false for the other layouts, left to nearest_span.
+RESIZE_KERNEL_CLONES
+bool replicate_span(const const_image_view& source, const resize_kernels::axis_table& columns, int factor, int source_y, int x_begin, int x_end, const image_view& destination, int y) {
+    int x0 = columns.first.front();
+    int last = columns.first.back() - x0;
+    if (source.has_contiguous_pixels() && destination.has_contiguous_pixels()) {
+        const unsigned char* source_row = source.row(source_y, 0) + static_cast<std::ptrdiff_t>(x0) * source.spectrum;
+        unsigned char* destination_row = destination.row(y, 0);
+        switch (source.spectrum) {
+        case 1:
+            replicate_row<1>(factor, source_row, last, x_begin, x_end, destination_row);
+            return true;
+        case 3:
+            replicate_row<3>(factor, source_row, last, x_begin, x_end, destination_row);
+            return true;
+        case 4:
+            replicate_row<4>(factor, source_row, last, x_begin, x_end, destination_row);
+            return true;
+        }
+    }
+    if (source.has_contiguous_rows() && destination.has_contiguous_rows()) {
+        for (int c = 0; c < source.spectrum; ++c) {
+            replicate_row<1>(factor, source.row(source_y, c) + x0, last, x_begin, x_end, destination.row(y, c));
+        }
+        return true;
+    }
+    return false;
+}
+
+// Copies the columns [x_begin, x_end) of destination row from_y to row y, for consecutive
+// rows sampling the same source row
+void copy_span(const image_view& destination, int from_y, int y, int x_begin, int x_end) {
+    std::size_t count = static_cast<std::size_t>(x_end - x_begin);
+    if (destination.has_contiguous_pixels()) {
+        std::ptrdiff_t offset = static_cast<std::ptrdiff_t>(x_begin) * destination.spectrum;
+        std::memcpy(destination.row(y, 0) + offset, destination.row(from_y, 0) + offset, count * destination.spectrum);
+        return;
+    }
+    if (destination.has_contiguous_rows()) {
+        for (int c = 0; c < destination.spectrum; ++c) {
+            std::memcpy(destination.row(y, c) + x_begin, destination.row(from_y, c) + x_begin, count);
+        }
+        return;
+    }
+    for (int c = 0; c < destination.spectrum; ++c) {
+        for (int x = x_begin; x < x_end; ++x) {
+            destination(x, y, c) = destination(x, from_y, c);
+        }
+    }
+}
 
-    return result;
+// Warps the columns [x_begin, x_end) of one destination row, all of whose taps lie inside
+// the source, stepping the source coordinates from column to column
+RESIZE_KERNEL_CLONES
+void nearest_warp_span(const const_image_view& source, double x_step, double y_step, double& src_x, double& src_y, int x_begin, int x_end, const image_view& destination, int y) {
+    double x_position = src_x;
+    double y_position = src_y;
+    for (int x = x_begin; x < x_end; ++x) {
+        for (int c = 0; c < source.spectrum; ++c) {
+            destination(x, y, c) = resize_kernels::nearest_sample_inside(source, static_cast<float>(x_position), static_cast<float>(y_position), c);
+        }
+        x_position += x_step;
+        y_position += y_step;
+    }
+    src_x = x_position;
+    src_y = y_position;
 }
 
-unsigned char resize_nearest_neighbour::estimate_color(const cimg_library::CImg<unsigned char>& source, float x, float y, int channel) const {
-    int nearest_x = static_cast<int>(round(x));
-    int nearest_y = static_cast<int>(round(y));
-    nearest_x = std::max(0, std::min(nearest_x, source.width() - 1));
-    nearest_y = std::max(0, std::min(nearest_y, source.height() - 1));
-    //std::cout << "Nearest neighbour estimate color at (" << nearest_x << ", " << nearest_y << ") in channel " << channel << std::endl;
-    return source(nearest_x, nearest_y, 0, channel);
+// One size of a shared pass over the source rows: its tables and the first destination row
+// not written yet
+struct shared_output {
+    shared_output(const const_image_view& source, const image_view& destination) : destination(destination) {
+        float x_ratio = static_cast<float>(source.width) / destination.width;
+        float y_ratio = static_cast<float>(source.height) / destination.height;
+        columns = resize_kernels::nearest_axis(0.0f, x_ratio, static_cast<float>(source.width - 1), destination.width, source.width);
+        rows = resize_kernels::nearest_axis(0.0f, y_ratio, static_cast<float>(source.height - 1), destination.height, source.height);
+        factor = replication_factor(columns);
+    }
+
+    image_view destination;
+    resize_kernels::axis_table columns;
+    resize_kernels::axis_table rows;
+    int factor;
+    int next_row = 0;
+};
+
+} // namespace
+
+void resize_nearest_neighbour::resize_region(const const_image_view& source, const image_region& region, const image_view& destination) const {
+    image_region clipped = clip_region(source, region, destination);
+
+    // Large downscales sample a blurred copy of the region when antialiasing is enabled
+    gaussian_prefilter prefilter;
+    const_image_view sampled = prefiltered_source(source, clipped, destination, prefilter);
+    int new_width = destination.width;
+    int new_height = destination.height;
+    float x_ratio = clipped.width / new_width;
+    float y_ratio = clipped.height / new_height;
+
+    // Last source pixel overlapping the region, so that no sample reaches outside of it
+    float x_last = std::ceil(clipped.x + clipped.width) - 1;
+    float y_last = std::ceil(clipped.y + clipped.height) - 1;
+
+    std::vector<image_tile> tiles = plan_tiles(new_width, new_height, sampled.spectrum, x_ratio, y_ratio, tiling());
+
+    // Every sample of a halving lands on a source pixel, which its integer kernel copies
+    if (detect_exact_ratio(clipped, x_ratio, y_ratio) == exact_ratio::half) {
+        int x0 = static_cast<int>(clipped.x);
+        int y0 = static_cast<int>(clipped.y);
+        for_each_tile(tiles, tiling().thread_count, [&](const image_tile& tile) {
+            for (int y = tile.y; y < tile.y + tile.height; ++y) {
+                halve_span(sampled, x0, y0, y, tile.x, tile.x + tile.width, destination);
+            }
+        });
+        return;
+    }
+
+    // The tables are shared by all tiles, each tile only touches the source pixels it samples
+    resize_kernels::axis_table columns = resize_kernels::nearest_axis(clipped.x, x_ratio, x_last, new_width, sampled.width);
+    resize_kernels::axis_table rows = resize_kernels::nearest_axis(clipped.y, y_ratio, y_last, new_height, sampled.height);
+    int factor = replication_factor(columns);
+    for_each_tile(tiles, tiling().thread_count, [&](const image_tile& tile) {
+        int x_end = tile.x + tile.width;
+        for (int y = tile.y; y < tile.y + tile.height; ++y) {
+            // Upscaled rows repeat the row above them when they sample the same source row
+            if (y > tile.y && rows.first[y] == rows.first[y - 1]) {
+                copy_span(destination, y - 1, y, tile.x, x_end);
+            } else if (factor == 0 || !replicate_span(sampled, columns, factor, rows.first[y], tile.x, x_end, destination, y)) {
+                nearest_span(sampled, columns, rows, y, tile.x, x_end, destination);
+            }
+        }
+    });
+}
+
+unsigned char resize_nearest_neighbour::estimate_color(const const_image_view& source, float x, float y, int channel, edge_mode edges) const {
+    return resize_kernels::nearest_sample(source, x, y, channel, edges);
+}
+
+void resize_nearest_neighbour::warp_inside(const const_image_view& source, const affine_transform& transform, double& src_x, double& src_y, int x_begin, int x_end, const image_view& destination, int y) const {
+    nearest_warp_span(source, transform.xx, transform.yx, src_x, src_y, x_begin, x_end, destination, y);
+}
+
+void resize_nearest_neighbour::resize_many(const const_image_view& source, const std::vector<image_view>& destinations) const {
+    // Prefiltering blurs the source differently for each size, and threads split the tiles
+    // of a single size, so both keep to one resize per size
+    if (antialiasing() || tiling().thread_count > 1) {
+        resize_image_base::resize_many(source, destinations);
+        return;
+    }
+    std::vector<shared_output> outputs;
+    outputs.reserve(destinations.size());
+    for (const image_view& destination : destinations) {
+        clip_region(source, image_region{0.0f, 0.0f, static_cast<float>(source.width), static_cast<float>(source.height)}, destination);
+        outputs.emplace_back(source, destination);
+    }
+
+    // Source rows are read in order, each once for all sizes, by the destination rows of
+    // every size sampling it
+    for (int source_row = 0; source_row < source.height; ++source_row) {
+        for (shared_output& output : outputs) {
+            const image_view& destination = output.destination;
+            int y = output.next_row;
+            for (; y < destination.height && output.rows.first[y] == source_row; ++y) {
+                if (y > 0 && output.rows.first[y - 1] == source_row) {
+                    copy_span(destination, y - 1, y, 0, destination.width);
+                } else if (output.factor == 0 || !replicate_span(source, output.columns, output.factor, source_row, 0, destination.width, destination, y)) {
+                    nearest_span(source, output.columns, output.rows, y, 0, destination.width, destination);
+                }
+            }
+            output.next_row = y;
+        }
+    }
 }
@@ -0,0 +1,175 @@
+#include "resize_protocol.h"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace resize_protocol {
+
+namespace {
+
+// Descriptors accepted from one message, all but the first are closed; the kernel closes
+// any that do not fit the control buffer
+const std::size_t max_attached_fds = 16;
+
+} // namespace
+
+void payload_writer::put_int(std::int32_t value) {
+    put_bytes(&value, sizeof(value));
+}
+
+void payload_writer::put_float(float value) {
+    put_bytes(&value, sizeof(value));
+}
+
+void payload_writer::put_string(const std::string& value) {
+    put_int(static_cast<std::int32_t>(value.size()));
+    put_bytes(value.data(), value.size());
+}
+
+void payload_writer::put_bytes(const void* bytes, std::size_t size) {
+    const unsigned char* begin = static_cast<const unsigned char*>(bytes);
+    data_.insert(data_.end(), begin, begin + size);
+}
+
+std::int32_t payload_reader::get_int() {
+    std::int32_t value;
+    get_bytes(&value, sizeof(value));
+    return value;
+}
+
+float payload_reader::get_float() {
+    float value;
+    get_bytes(&value, sizeof(value));
+    return value;
+}
+
+std::string payload_reader::get_string() {
+    std::int32_t size = get_int();
+    if (size < 0 || static_cast<std::size_t>(size) > data_.size() - offset_) {
+        throw std::runtime_error("truncated payload");
+    }
+    std::string value(reinterpret_cast<const char*>(data_.data()) + offset_, size);
+    offset_ += size;
+    return value;
+}
+
+void payload_reader::get_bytes(void* bytes, std::size_t size) {
+    if (size > data_.size() - offset_) {
+        throw std::runtime_error("truncated payload");
+    }
+    std::memcpy(bytes, data_.data() + offset_, size);
+    offset_ += size;
+}
+
+bool send_frame(int socket, std::uint16_t type, const std::vector<unsigned char>& payload, int fd) {
+    frame_header header{frame_magic, type, 0, static_cast<std::uint32_t>(payload.size())};
+    iovec parts[2] = {{&header, sizeof(header)}, {const_cast<unsigned char*>(payload.data()), payload.size()}};
+    std::size_t remaining = sizeof(header) + payload.size();
+
+    msghdr message{};
+    message.msg_iov = parts;
+    message.msg_iovlen = payload.empty() ? 1 : 2;
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+    if (fd >= 0) {
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+        cmsghdr* attachment = CMSG_FIRSTHDR(&message);
+        attachment->cmsg_level = SOL_SOCKET;
+        attachment->cmsg_type = SCM_RIGHTS;
+        attachment->cmsg_len = CMSG_LEN(sizeof(int));
+        std::memcpy(CMSG_DATA(attachment), &fd, sizeof(int));
+    }
+
+    while (remaining > 0) {
+        ssize_t sent = sendmsg(socket, &message, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent <= 0) {
+            return false;
+        }
+        remaining -= sent;
+
+        // The descriptor went with the first bytes, only the rest of the data is left
+        message.msg_control = nullptr;
+        message.msg_controllen = 0;
+        while (sent > 0 && static_cast<std::size_t>(sent) >= message.msg_iov->iov_len) {
+            sent -= message.msg_iov->iov_len;
+            ++message.msg_iov;
+            --message.msg_iovlen;
+        }
+        if (message.msg_iovlen > 0) {
+            message.msg_iov->iov_base = static_cast<char*>(message.msg_iov->iov_base) + sent;
+            message.msg_iov->iov_len -= sent;
+        }
+    }
+    return true;
+}
+
+bool receive_frame(int socket, frame& message) {
+    message = frame();
+    frame_header header;
+    unsigned char* buffer = reinterpret_cast<unsigned char*>(&header);
+    std::size_t received = 0;
+    while (received < sizeof(header)) {
+        iovec part{buffer + received, sizeof(header) - received};
+        msghdr incoming{};
+        incoming.msg_iov = &part;
+        incoming.msg_iovlen = 1;
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * max_attached_fds)];
+        incoming.msg_control = control;
+        incoming.msg_controllen = sizeof(control);
+
+        ssize_t count = recvmsg(socket, &incoming, MSG_CMSG_CLOEXEC);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            break;
+        }
+        for (cmsghdr* attachment = CMSG_FIRSTHDR(&incoming); attachment; attachment = CMSG_NXTHDR(&incoming, attachment)) {
+            if (attachment->cmsg_level != SOL_SOCKET || attachment->cmsg_type != SCM_RIGHTS) {
+                continue;
+            }
+            // Only the first descriptor belongs to the frame, any other one is closed
+            std::size_t count = (attachment->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            for (std::size_t i = 0; i < count; ++i) {
+                int fd;
+                std::memcpy(&fd, CMSG_DATA(attachment) + i * sizeof(int), sizeof(int));
+                if (message.fd < 0) {
+                    message.fd = fd;
+                } else {
+                    close(fd);
+                }
+            }
+        }
+        received += count;
+    }
+
+    bool valid = received == sizeof(header) && header.magic == frame_magic && header.length <= max_payload_length;
+    if (valid) {
+        message.type = header.type;
+        message.payload.resize(header.length);
+        received = 0;
+        while (received < header.length) {
+            ssize_t count = recv(socket, message.payload.data() + received, header.length - received, 0);
+            if (count < 0 && errno == EINTR) {
+                continue;
+            }
+            if (count <= 0) {
+                valid = false;
+                break;
+            }
+            received += count;
+        }
+    }
+    if (!valid && message.fd >= 0) {
+        close(message.fd);
+        message.fd = -1;
+    }
+    return valid;
+}
+
+} // namespace resize_protocol
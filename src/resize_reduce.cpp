@@ -0,0 +1,153 @@
+#include "resize_reduce.h"
+#include "kernel_dispatch.h"
+#include "resize_kernels.h"
+#include "resize_tiles.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace {
+
+// Folds count samples, step bytes apart, into the row buffer, keeping the larger or the
+// smaller value of each element. Contiguous samples are the vectorised case.
+RESIZE_KERNEL_CLONES
+void fold_row(const unsigned char* samples, std::ptrdiff_t step, int count, bool largest, unsigned char* band) {
+    if (step == 1 && largest) {
+        for (int i = 0; i < count; ++i) {
+            band[i] = std::max(band[i], samples[i]);
+        }
+    } else if (step == 1) {
+        for (int i = 0; i < count; ++i) {
+            band[i] = std::min(band[i], samples[i]);
+        }
+    } else {
+        for (int i = 0; i < count; ++i) {
+            unsigned char sample = samples[i * step];
+            band[i] = largest ? std::max(band[i], sample) : std::min(band[i], sample);
+        }
+    }
+}
+
+// Reduces the folded rows of a block, count elements step apart in the row buffer
+unsigned char reduce_band(const unsigned char* band, std::ptrdiff_t step, int count, bool largest) {
+    unsigned char result = band[0];
+    for (int i = 1; i < count; ++i) {
+        result = largest ? std::max(result, band[i * step]) : std::min(result, band[i * step]);
+    }
+    return result;
+}
+
+// Fills the columns [x_begin, x_end) of a destination row with the largest or smallest
+// value of each block. The rows of the blocks are folded over the source columns they
+// span, all channels at once when the pixels are interleaved, then each block of the
+// folded row is reduced.
+void extremum_span(const const_image_view& source, const resize_kernels::footprint_table& columns, int row_begin, int row_end, bool largest, int y, int x_begin, int x_end, const image_view& destination, std::vector<unsigned char>& band) {
+    int first = columns.begin[x_begin];
+    int span = columns.end[x_end - 1] - first;
+    bool interleaved = source.has_contiguous_pixels();
+    // Position in the row buffer of the column first + i of channel c
+    std::ptrdiff_t pixel_step = interleaved ? source.spectrum : 1;
+    std::ptrdiff_t channel_step = interleaved ? 1 : span;
+
+    band.assign(static_cast<std::size_t>(span) * source.spectrum, largest ? 0 : 255);
+    for (int r = row_begin; r < row_end; ++r) {
+        if (interleaved) {
+            fold_row(source.row(r, 0) + first * source.x_stride, 1, span * source.spectrum, largest, band.data());
+            continue;
+        }
+        for (int c = 0; c < source.spectrum; ++c) {
+            fold_row(source.row(r, c) + first * source.x_stride, source.x_stride, span, largest, &band[c * channel_step]);
+        }
+    }
+    for (int c = 0; c < source.spectrum; ++c) {
+        for (int x = x_begin; x < x_end; ++x) {
+            const unsigned char* block = &band[(columns.begin[x] - first) * pixel_step + c * channel_step];
+            destination(x, y, c) = reduce_band(block, pixel_step, columns.end[x] - columns.begin[x], largest);
+        }
+    }
+}
+
+// Tells whether every sample of a block of one channel equals its first one
+bool uniform_block(const const_image_view& source, int column_begin, int column_end, int row_begin, int row_end, int channel) {
+    unsigned char first = source.row(row_begin, channel)[column_begin * source.x_stride];
+    for (int r = row_begin; r < row_end; ++r) {
+        const unsigned char* samples = source.row(r, channel);
+        bool equal = true;
+        for (int i = column_begin; i < column_end; ++i) {
+            equal &= samples[i * source.x_stride] == first;
+        }
+        if (!equal) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Fills the columns [x_begin, x_end) of a destination row with the most frequent value of
+// each block, reading the block row by row. Uniform blocks, the bulk of a label mask, are
+// detected first and skip the histogram. Otherwise the leader is updated whenever a count
+// reaches or passes its own, so the histogram is never scanned; the counts of the block
+// are reset afterwards by walking it again.
+void mode_span(const const_image_view& source, const resize_kernels::footprint_table& columns, int row_begin, int row_end, int y, int x_begin, int x_end, const image_view& destination, std::uint32_t counts[256]) {
+    for (int c = 0; c < source.spectrum; ++c) {
+        for (int x = x_begin; x < x_end; ++x) {
+            int column_begin = columns.begin[x];
+            int column_end = columns.end[x];
+            if (uniform_block(source, column_begin, column_end, row_begin, row_end, c)) {
+                destination(x, y, c) = source.row(row_begin, c)[column_begin * source.x_stride];
+                continue;
+            }
+            unsigned char leader = 0;
+            std::uint32_t leader_count = 0;
+            for (int r = row_begin; r < row_end; ++r) {
+                const unsigned char* samples = source.row(r, c);
+                for (int i = column_begin; i < column_end; ++i) {
+                    unsigned char value = samples[i * source.x_stride];
+                    std::uint32_t count = ++counts[value];
+                    if (count > leader_count || (count == leader_count && value < leader)) {
+                        leader = value;
+                        leader_count = count;
+                    }
+                }
+            }
+            for (int r = row_begin; r < row_end; ++r) {
+                const unsigned char* samples = source.row(r, c);
+                for (int i = column_begin; i < column_end; ++i) {
+                    counts[samples[i * source.x_stride]] = 0;
+                }
+            }
+            destination(x, y, c) = leader;
+        }
+    }
+}
+
+} // namespace
+
+void resize_reduce::resize_region(const const_image_view& source, const image_region& region, const image_view& destination) const {
+    image_region clipped = clip_region(source, region, destination);
+
+    int new_width = destination.width;
+    int new_height = destination.height;
+    float x_ratio = clipped.width / new_width;
+    float y_ratio = clipped.height / new_height;
+    resize_kernels::footprint_table columns = resize_kernels::footprint_axis(clipped.x, x_ratio, static_cast<int>(clipped.x), static_cast<int>(std::ceil(clipped.x + clipped.width)), new_width);
+    resize_kernels::footprint_table rows = resize_kernels::footprint_axis(clipped.y, y_ratio, static_cast<int>(clipped.y), static_cast<int>(std::ceil(clipped.y + clipped.height)), new_height);
+
+    std::vector<image_tile> tiles = plan_tiles(new_width, new_height, source.spectrum, x_ratio, y_ratio, tiling());
+    for_each_tile(tiles, tiling().thread_count, [&](const image_tile& tile) {
+        std::vector<unsigned char> band;
+        std::uint32_t counts[256] = {};
+        for (int y = tile.y; y < tile.y + tile.height; ++y) {
+            if (kind_ == reduction::mode) {
+                mode_span(source, columns, rows.begin[y], rows.end[y], y, tile.x, tile.x + tile.width, destination, counts);
+            } else {
+                extremum_span(source, columns, rows.begin[y], rows.end[y], kind_ == reduction::max, y, tile.x, tile.x + tile.width, destination, band);
+            }
+        }
+    });
+}
+
+void resize_reduce::resize_many(const const_image_view& source, const std::vector<image_view>& destinations) const {
+    // Blocks are not the nearest neighbour's samples, so its shared pass does not apply
+    resize_image_base::resize_many(source, destinations);
+}
@@ -0,0 +1,236 @@
+#include "resize_server.h"
+#include "resize_job.h"
+#include "cimg_adapter.h"
+#include "shared_image.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace cimg_library;
+using namespace resize_protocol;
+
+namespace {
+
+frame success_reply(int width, int height, int spectrum, int fd) {
+    payload_writer reply;
+    reply.put_int(0);
+    reply.put_int(width);
+    reply.put_int(height);
+    reply.put_int(spectrum);
+    reply.put_string("");
+    return frame{resize_protocol::reply, reply.data(), fd};
+}
+
+frame shared_reply(const CImg<unsigned char>& image) {
+    shared_image result = shared_image::create(image.width(), image.height(), image.spectrum());
+    std::copy(image.begin(), image.end(), result.data());
+    return success_reply(image.width(), image.height(), image.spectrum(), dup(result.fd()));
+}
+
+frame error_reply(const std::string& message) {
+    payload_writer reply;
+    reply.put_int(1);
+    reply.put_int(0);
+    reply.put_int(0);
+    reply.put_int(0);
+    reply.put_string(message);
+    return frame{resize_protocol::reply, reply.data(), -1};
+}
+
+std::string oversized_output_message() {
+    return "results are limited to " + std::to_string(resize_server::max_output_pixels) + " pixels";
+}
+
+} // namespace
+
+resize_server::resize_server(const std::string& socket_path, int thread_count, resize_cache* cache, int tile_threads)
+    : socket_path_(socket_path), thread_count_(thread_count), cache_(cache), tile_threads_(tile_threads), listener_(-1), running_(false) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("socket path too long: " + socket_path);
+    }
+    std::strcpy(address.sun_path, socket_path.c_str());
+
+    listener_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listener_ < 0) {
+        throw std::runtime_error(std::string("cannot create socket: ") + std::strerror(errno));
+    }
+    unlink(socket_path.c_str());
+    if (bind(listener_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || listen(listener_, SOMAXCONN) < 0) {
+        int error = errno;
+        close(listener_);
+        throw std::runtime_error("cannot listen on " + socket_path + ": " + std::strerror(error));
+    }
+}
+
+resize_server::~resize_server() {
+    close(listener_);
+    unlink(socket_path_.c_str());
+}
+
+void resize_server::run() {
+    running_ = true;
+    auto worker = [this]() {
+        while (running_) {
+            int connection = accept4(listener_, nullptr, nullptr, SOCK_CLOEXEC);
+            if (connection < 0) {
+                if (errno == EINTR || errno == ECONNABORTED) {
+                    continue;
+                }
+                break;
+            }
+            serve_connection(connection);
+            close(connection);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int t = 1; t < thread_count_; ++t) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : workers) {
+        thread.join();
+    }
+}
+
+void resize_server::stop() {
+    running_ = false;
+    shutdown(listener_, SHUT_RDWR);
+}
+
+void resize_server::serve_connection(int connection) const {
+    frame request;
+    while (receive_frame(connection, request)) {
+        frame response;
+        if (request.type == resize_file) {
+            response = handle_resize_file(request);
+        } else if (request.type == resize_shared) {
+            response = handle_resize_shared(request);
+        } else {
+            response = error_reply("unsupported message type " + std::to_string(request.type));
+        }
+        if (request.fd >= 0) {
+            close(request.fd);
+        }
+
+        bool sent = send_frame(connection, response.type, response.payload, response.fd);
+        if (response.fd >= 0) {
+            close(response.fd);
+        }
+        if (!sent) {
+            break;
+        }
+    }
+}
+
+frame resize_server::handle_resize_file(const frame& request) const {
+    try {
+        payload_reader fields(request.payload);
+        resize_job job;
+        job.width = fields.get_int();
+        job.height = fields.get_int();
+        job.scale = fields.get_float();
+        job.quality = fields.get_int();
+        job.keep_grey = fields.get_int() != 0;
+        job.antialias = fields.get_int() != 0;
+        job.method = fields.get_string();
+        job.input = fields.get_string();
+        job.output = fields.get_string();
+        job.tile_threads = tile_threads_;
+        validate_job(job);
+
+        std::string key;
+        if (cache_) {
+            key = job_cache_key(job);
+            if (resize_cache::image_ptr cached = cache_->lookup(key)) {
+                if (job.output.empty()) {
+                    return shared_reply(*cached);
+                }
+                save_job_output(job, *cached);
+                return success_reply(cached->width(), cached->height(), cached->spectrum(), -1);
+            }
+        }
+
+        job_input input = open_job_input(job);
+        image_size size = job_output_size(job, input);
+        int spectrum = job_output_spectrum(job, input);
+        if (static_cast<long long>(size.width) * size.height > max_output_pixels) {
+            return error_reply(oversized_output_message());
+        }
+
+        if (!job.output.empty()) {
+            CImg<unsigned char> resized_image(size.width, size.height, 1, spectrum, 0);
+            resize_job_into(job, input, view_of(resized_image));
+            if (cache_) {
+                cache_->store(key, resized_image);
+            }
+            save_job_output(job, resized_image);
+            return success_reply(size.width, size.height, spectrum, -1);
+        }
+
+        // Resize straight into shared memory handed over to the client
+        shared_image result = shared_image::create(size.width, size.height, spectrum);
+        CImg<unsigned char> result_view = result.view();
+        resize_job_into(job, input, view_of(result_view));
+        if (cache_) {
+            cache_->store(key, result_view);
+        }
+        return success_reply(size.width, size.height, spectrum, dup(result.fd()));
+    } catch (const std::exception& error) {
+        return error_reply(error.what());
+    }
+}
+
+frame resize_server::handle_resize_shared(frame& request) const {
+    try {
+        payload_reader fields(request.payload);
+        std::string method = fields.get_string();
+        int new_width = fields.get_int();
+        int new_height = fields.get_int();
+        int source_width = fields.get_int();
+        int source_height = fields.get_int();
+        int spectrum = fields.get_int();
+        std::unique_ptr<resize_image_base> resizer = create_resizer(method, tile_options{0, tile_threads_});
+        if (request.fd < 0) {
+            return error_reply("resize_shared request without source memory");
+        }
+        if (new_width <= 0 || new_height <= 0) {
+            return error_reply("result dimensions must be positive");
+        }
+        if (static_cast<long long>(new_width) * new_height > max_output_pixels) {
+            return error_reply(oversized_output_message());
+        }
+
+        // Both images are views over shared memory, the pixels are never copied
+        int source_fd = request.fd;
+        request.fd = -1;
+        shared_image source = shared_image::adopt(source_fd, source_width, source_height, spectrum, false);
+        std::string key;
+        if (cache_) {
+            std::string parameters = method + "_" + std::to_string(source_width) + "x" + std::to_string(source_height) + "x" + std::to_string(spectrum) + "_to_" + std::to_string(new_width) + "x" + std::to_string(new_height);
+            key = resize_cache::make_key(resize_cache::hash_bytes(source.data(), source.size()), parameters);
+            if (resize_cache::image_ptr cached = cache_->lookup(key)) {
+                return shared_reply(*cached);
+            }
+        }
+
+        shared_image result = shared_image::create(new_width, new_height, spectrum);
+        const CImg<unsigned char> source_view = source.view();
+        CImg<unsigned char> result_view = result.view();
+        resizer->resize_region(source_view, image_region{0.0f, 0.0f, static_cast<float>(source_width), static_cast<float>(source_height)}, result_view);
+        if (cache_) {
+            cache_->store(key, result_view);
+        }
+        return success_reply(new_width, new_height, spectrum, dup(result.fd()));
+    } catch (const std::exception& error) {
+        return error_reply(error.what());
+    }
+}
@@ -0,0 +1,76 @@
+#include "resize_tiles.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+// Used when the system does not report its L2 cache size
+const std::size_t fallback_cache_bytes = 256 * 1024;
+
+// Narrowest tile worth cutting a row into, in pixels
+const int minimum_tile_width = 64;
+
+std::size_t cache_budget(const tile_options& options) {
+    if (options.cache_bytes > 0) {
+        return options.cache_bytes;
+    }
+    static const std::size_t detected = []() {
+        long l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+        return l2 > 0 ? static_cast<std::size_t>(l2) / 2 : fallback_cache_bytes;
+    }();
+    return detected;
+}
+
+// Bytes of source and destination pixels touched by a tile of the given size
+double working_set(int width, int height, int spectrum, float x_ratio, float y_ratio) {
+    double source = (width * static_cast<double>(x_ratio) + 2) * (height * static_cast<double>(y_ratio) + 2);
+    return (source + static_cast<double>(width) * height) * spectrum;
+}
+
+} // namespace
+
+std::vector<image_tile> plan_tiles(int width, int height, int spectrum, float x_ratio, float y_ratio, const tile_options& options) {
+    double budget = static_cast<double>(cache_budget(options));
+
+    // Keep full rows unless fewer than a handful of them fit
+    int tile_width = width;
+    if (working_set(width, 4, spectrum, x_ratio, y_ratio) > budget) {
+        double side = std::sqrt(budget / working_set(1, 1, spectrum, x_ratio, y_ratio));
+        tile_width = std::min(width, std::max(minimum_tile_width, static_cast<int>(side)));
+    }
+    int tile_height = 1;
+    while (tile_height < height && working_set(tile_width, tile_height * 2, spectrum, x_ratio, y_ratio) <= budget) {
+        tile_height *= 2;
+    }
+    tile_height = std::min(tile_height, height);
+
+    std::vector<image_tile> tiles;
+    for (int y = 0; y < height; y += tile_height) {
+        for (int x = 0; x < width; x += tile_width) {
+            tiles.push_back(image_tile{x, y, std::min(tile_width, width - x), std::min(tile_height, height - y)});
+        }
+    }
+    return tiles;
+}
+
+void for_each_tile(const std::vector<image_tile>& tiles, int thread_count, const std::function<void(const image_tile&)>& process) {
+    std::atomic<std::size_t> next_tile(0);
+    auto worker = [&]() {
+        for (std::size_t i = next_tile++; i < tiles.size(); i = next_tile++) {
+            process(tiles[i]);
+        }
+    };
+
+    int extra_threads = static_cast<int>(std::min<std::size_t>(std::max(thread_count, 1), tiles.size())) - 1;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < extra_threads; ++t) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : workers) {
+        thread.join();
+    }
+}
@@ -0,0 +1,107 @@
+#include "shared_image.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+void check_dimensions(int width, int height, int spectrum) {
+    if (width <= 0 || height <= 0 || spectrum <= 0) {
+        throw std::invalid_argument("shared image dimensions must be positive");
+    }
+}
+
+} // namespace
+
+shared_image::shared_image() : fd_(-1), data_(nullptr), width_(0), height_(0), spectrum_(0) {}
+
+shared_image::shared_image(int fd, unsigned char* data, int width, int height, int spectrum)
+    : fd_(fd), data_(data), width_(width), height_(height), spectrum_(spectrum) {}
+
+shared_image shared_image::create(int width, int height, int spectrum) {
+    check_dimensions(width, height, spectrum);
+    std::size_t bytes = static_cast<std::size_t>(width) * height * spectrum;
+    int fd = memfd_create("shared_image", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd < 0) {
+        throw std::runtime_error(std::string("cannot create shared memory: ") + std::strerror(errno));
+    }
+    if (ftruncate(fd, bytes) < 0) {
+        int error = errno;
+        close(fd);
+        throw std::runtime_error(std::string("cannot allocate shared memory: ") + std::strerror(error));
+    }
+    // Neither process may resize the memory while the other has it mapped
+    if (fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW) < 0) {
+        int error = errno;
+        close(fd);
+        throw std::runtime_error(std::string("cannot seal shared memory: ") + std::strerror(error));
+    }
+    return adopt(fd, width, height, spectrum, true);
+}
+
+shared_image shared_image::adopt(int fd, int width, int height, int spectrum, bool writable) {
+    try {
+        check_dimensions(width, height, spectrum);
+        std::size_t bytes = static_cast<std::size_t>(width) * height * spectrum;
+        // A peer able to shrink the memory would make reading the mapping raise SIGBUS
+        int seals = fcntl(fd, F_GET_SEALS);
+        if (seals < 0 || !(seals & F_SEAL_SHRINK)) {
+            throw std::invalid_argument("shared memory must be a memfd sealed against shrinking");
+        }
+        struct stat info;
+        if (fstat(fd, &info) < 0 || static_cast<std::size_t>(info.st_size) < bytes) {
+            throw std::invalid_argument("shared memory is smaller than the image it should hold");
+        }
+        void* data = mmap(nullptr, bytes, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+        if (data == MAP_FAILED) {
+            throw std::runtime_error(std::string("cannot map shared memory: ") + std::strerror(errno));
+        }
+        return shared_image(fd, static_cast<unsigned char*>(data), width, height, spectrum);
+    } catch (...) {
+        close(fd);
+        throw;
+    }
+}
+
+shared_image::~shared_image() {
+    release();
+}
+
+shared_image::shared_image(shared_image&& other) noexcept
+    : fd_(other.fd_), data_(other.data_), width_(other.width_), height_(other.height_), spectrum_(other.spectrum_) {
+    other.fd_ = -1;
+    other.data_ = nullptr;
+}
+
+shared_image& shared_image::operator=(shared_image&& other) noexcept {
+    if (this != &other) {
+        release();
+        fd_ = other.fd_;
+        data_ = other.data_;
+        width_ = other.width_;
+        height_ = other.height_;
+        spectrum_ = other.spectrum_;
+        other.fd_ = -1;
+        other.data_ = nullptr;
+    }
+    return *this;
+}
+
+cimg_library::CImg<unsigned char> shared_image::view() const {
+    return cimg_library::CImg<unsigned char>(data_, width_, height_, 1, spectrum_, true);
+}
+
+void shared_image::release() {
+    if (data_) {
+        munmap(data_, size());
+        data_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        close(fd_);
+        fd_ = -1;
+    }
+}
@@ -0,0 +1,120 @@
+#include "summed_area_table.h"
+#include "kernel_dispatch.h"
+#include "resize_kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+// Source pixels [begin[i], end[i]) averaged into destination index i along one axis, and
+// the inverse of their count
+struct box_axis {
+    std::vector<int> begin;
+    std::vector<int> end;
+    std::vector<double> inverse;
+    int largest = 0;
+};
+
+// Added to the scaled sums before truncation. Means are at most 256 and computed with a
+// relative error of a few 2^-53, far below this, while a box of at most max_box_area
+// pixels keeps the fraction of a mean that is not an integer above 2^-24.
+const double rounding_margin = 1.0 / (1 << 30);
+
+// Rounds the footprints of count destination pixels to source pixels within
+// [first, last_end) with resize_kernels::footprint_edges
+box_axis box_edges(float start, float ratio, int first, int last_end, int count) {
+    box_axis axis;
+    axis.begin.resize(count);
+    axis.end.resize(count);
+    axis.inverse.resize(count);
+    for (int i = 0; i < count; ++i) {
+        int begin;
+        int end;
+        resize_kernels::footprint_edges(start, ratio, first, last_end, i, begin, end);
+        axis.begin[i] = begin;
+        axis.end[i] = end;
+        axis.inverse[i] = 1.0 / (end - begin);
+        axis.largest = std::max(axis.largest, end - begin);
+    }
+    return axis;
+}
+
+// Fills the table of one channel: each row is the running sum of its pixels, to which the
+// row above is added; the additions of whole rows are cloned per instruction set level
+RESIZE_KERNEL_CLONES
+void sum_channel(const const_image_view& source, int channel, std::uint32_t* sums) {
+    std::size_t stride = static_cast<std::size_t>(source.width) + 1;
+    for (int y = 0; y < source.height; ++y) {
+        const unsigned char* pixels = source.row(y, channel);
+        const std::uint32_t* above = sums + y * stride;
+        std::uint32_t* row = sums + (y + 1) * stride;
+        std::uint32_t running = 0;
+        row[0] = 0;
+        for (int x = 0; x < source.width; ++x) {
+            running += pixels[x * source.x_stride];
+            row[x + 1] = running;
+        }
+        for (std::size_t x = 1; x < stride; ++x) {
+            row[x] += above[x];
+        }
+    }
+}
+
+// Writes the rounded box means of one channel of the columns [x_begin, x_end) of a
+// destination row, from the table rows at
+// the top and bottom edges of its boxes. The division by the area is a multiplication by its
+// inverse, exact after truncation thanks to the rounding margin.
+RESIZE_KERNEL_CLONES
+void box_row(const std::uint32_t* top, const std::uint32_t* bottom, int box_height, double inverse_height, const box_axis& columns, const image_view& destination, int y, int channel, int x_begin, int x_end) {
+    for (int x = x_begin; x < x_end; ++x) {
+        int x0 = columns.begin[x];
+        int x1 = columns.end[x];
+        std::uint32_t sum = bottom[x1] - bottom[x0] - top[x1] + top[x0];
+        std::uint32_t half_area = static_cast<std::uint32_t>((x1 - x0) * box_height) / 2;
+        double mean = static_cast<double>(sum + half_area) * (columns.inverse[x] * inverse_height);
+        destination(x, y, channel) = static_cast<unsigned char>(mean + rounding_margin);
+    }
+}
+
+} // namespace
+
+summed_area_table::summed_area_table(const const_image_view& source)
+    : width_(source.width), height_(source.height), spectrum_(source.spectrum),
+      sums_(static_cast<std::size_t>(source.spectrum) * (source.height + 1) * (source.width + 1), 0) {
+    for (int c = 0; c < spectrum_; ++c) {
+        sum_channel(source, c, &sums_[static_cast<std::size_t>(c) * (height_ + 1) * (width_ + 1)]);
+    }
+}
+
+void summed_area_table::resize_region(const image_region& region, const image_view& destination, const tile_options& tiling) const {
+    if (destination.spectrum != spectrum_) {
+        throw std::invalid_argument("destination spectrum does not match the source image");
+    }
+    float x0 = std::max(region.x, 0.0f);
+    float y0 = std::max(region.y, 0.0f);
+    float x1 = std::min(region.x + region.width, static_cast<float>(width_));
+    float y1 = std::min(region.y + region.height, static_cast<float>(height_));
+    if (x1 <= x0 || y1 <= y0) {
+        throw std::invalid_argument("resize region does not overlap the source image");
+    }
+
+    float x_ratio = (x1 - x0) / destination.width;
+    float y_ratio = (y1 - y0) / destination.height;
+    box_axis columns = box_edges(x0, x_ratio, static_cast<int>(x0), static_cast<int>(std::ceil(x1)), destination.width);
+    box_axis rows = box_edges(y0, y_ratio, static_cast<int>(y0), static_cast<int>(std::ceil(y1)), destination.height);
+    if (static_cast<std::uint64_t>(columns.largest) * rows.largest > max_box_area) {
+        throw std::invalid_argument("box filter boxes are limited to 16777215 pixels");
+    }
+
+    // Tiles keep the table entries read by each thread to the boxes of its destination pixels
+    std::vector<image_tile> tiles = plan_tiles(destination.width, destination.height, spectrum_, x_ratio, y_ratio, tiling);
+    for_each_tile(tiles, tiling.thread_count, [&](const image_tile& tile) {
+        for (int y = tile.y; y < tile.y + tile.height; ++y) {
+            int box_height = rows.end[y] - rows.begin[y];
+            for (int c = 0; c < spectrum_; ++c) {
+                box_row(entry(rows.begin[y], c), entry(rows.end[y], c), box_height, rows.inverse[y], columns, destination, y, c, tile.x, tile.x + tile.width);
+            }
+        }
+    });
+}
@@ -0,0 +1,151 @@
+#include "test_check.h"
+#include "resize_box.h"
+#include "resize_kernels.h"
+#include "summed_area_table.h"
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace {
+
+// Rounded mean of a box of one channel, summed pixel by pixel
+unsigned char brute_force_mean(const const_image_view& source, int x0, int x1, int y0, int y1, int channel) {
+    unsigned sum = 0;
+    for (int y = y0; y < y1; ++y) {
+        for (int x = x0; x < x1; ++x) {
+            sum += source(x, y, channel);
+        }
+    }
+    unsigned area = static_cast<unsigned>((x1 - x0) * (y1 - y0));
+    return static_cast<unsigned char>((sum + area / 2) / area);
+}
+
+// Fills an image with random values, only 255, or only 0 and 255: the saturated images put
+// the means exactly on or halfway between integers, where rounding is decided
+void fill(test::image& image, std::mt19937& random, int pattern) {
+    for (int c = 0; c < image.view.spectrum; ++c) {
+        for (int y = 0; y < image.view.height; ++y) {
+            for (int x = 0; x < image.view.width; ++x) {
+                image.view(x, y, c) = pattern == 0 ? static_cast<unsigned char>(random()) : pattern == 1 ? 255 : (random() % 2) * 255;
+            }
+        }
+    }
+}
+
+void test_box_matches_brute_force(std::mt19937& random) {
+    const test::layout layouts[] = {test::layout::planar, test::layout::interleaved, test::layout::strided};
+    resize_box box;
+    for (int iteration = 0; iteration < 300; ++iteration) {
+        int width = 1 + random() % 150;
+        int height = 1 + random() % 100;
+        int spectrum = 1 + random() % 4;
+        test::image source(width, height, spectrum, layouts[random() % 3]);
+        fill(source, random, iteration % 3);
+
+        image_region region{0.0f, 0.0f, static_cast<float>(width), static_cast<float>(height)};
+        if (iteration % 2) {
+            region.x = (random() % 1000) / 1000.0f * width / 2;
+            region.y = (random() % 1000) / 1000.0f * height / 2;
+            region.width = std::max(0.5f, (random() % 1000) / 1000.0f * (width - region.x));
+            region.height = std::max(0.5f, (random() % 1000) / 1000.0f * (height - region.y));
+        }
+        int new_width = 1 + random() % (2 * width);
+        int new_height = 1 + random() % (2 * height);
+        test::image result(new_width, new_height, spectrum, layouts[random() % 3]);
+        box.set_tiling(random() % 2 ? tile_options{1 + random() % 4000, 1 + static_cast<int>(random() % 3)} : tile_options());
+        box.resize_region(source.view, region, result.view);
+
+        float x_end = std::min(region.x + region.width, static_cast<float>(width));
+        float y_end = std::min(region.y + region.height, static_cast<float>(height));
+        long mismatches = 0;
+        for (int y = 0; y < new_height; ++y) {
+            int y0, y1;
+            resize_kernels::footprint_edges(region.y, (y_end - region.y) / new_height, static_cast<int>(region.y), static_cast<int>(std::ceil(y_end)), y, y0, y1);
+            for (int x = 0; x < new_width; ++x) {
+                int x0, x1;
+                resize_kernels::footprint_edges(region.x, (x_end - region.x) / new_width, static_cast<int>(region.x), static_cast<int>(std::ceil(x_end)), x, x0, x1);
+                for (int c = 0; c < spectrum; ++c) {
+                    mismatches += result.view(x, y, c) != brute_force_mean(source.view, x0, x1, y0, y1, c);
+                }
+            }
+        }
+        CHECK(mismatches == 0);
+    }
+}
+
+// The footprints shared by the box and reduction filters, checked by their properties
+// rather than by the same rounding: downscales split the axis into consecutive blocks
+// covering every pixel once, upscales keep the one pixel under each left edge, and a
+// region's blocks stay within the pixels overlapping it
+void test_footprints(std::mt19937& random) {
+    for (int iteration = 0; iteration < 2000; ++iteration) {
+        int size = 1 + random() % 500;
+        int count = 1 + random() % 1000;
+        float ratio = static_cast<float>(size) / count;
+        int previous_end = 0;
+        for (int i = 0; i < count; ++i) {
+            int begin, end;
+            resize_kernels::footprint_edges(0.0f, ratio, 0, size, i, begin, end);
+            CHECK(begin >= 0 && end <= size && end > begin);
+            if (count <= size) {
+                CHECK(begin == previous_end);
+                CHECK(end - begin <= static_cast<int>(std::ceil(ratio)) + 1);
+            } else {
+                CHECK(end == begin + 1);
+                CHECK(std::abs(begin - i * ratio) <= 0.5f || begin == size - 1);
+            }
+            previous_end = end;
+        }
+        if (count <= size) {
+            CHECK(previous_end == size);
+        }
+
+        float start = (random() % 1000) / 100.0f;
+        float width = 0.5f + (random() % 1000) / 10.0f;
+        int first = static_cast<int>(start);
+        int last_end = static_cast<int>(std::ceil(start + width));
+        for (int i = 0; i < count; ++i) {
+            int begin, end;
+            resize_kernels::footprint_edges(start, width / count, first, last_end, i, begin, end);
+            CHECK(begin >= first && end <= last_end && end > begin);
+        }
+    }
+}
+
+// The wrapping 32-bit sums still give exact box sums, also over an image whose total
+// overflows them
+void test_box_sums(std::mt19937& random) {
+    test::image source(4200, 4100, 1, test::layout::planar);
+    fill(source, random, 1);
+    summed_area_table table(source.view);
+    for (int i = 0; i < 200; ++i) {
+        int x0 = random() % 4200;
+        int y0 = random() % 4100;
+        int x1 = std::min(4200, x0 + 1 + static_cast<int>(random() % 4000));
+        int y1 = std::min(4100, y0 + 1 + static_cast<int>(random() % 4000));
+        if (static_cast<std::uint64_t>(x1 - x0) * (y1 - y0) > summed_area_table::max_box_area) {
+            continue;
+        }
+        CHECK(table.box_sum(x0, y0, x1, y1, 0) == 255u * (x1 - x0) * (y1 - y0));
+    }
+
+    // A single box of the whole image exceeds max_box_area
+    std::vector<unsigned char> pixel(1);
+    bool thrown = false;
+    try {
+        table.resize(image_view::planar(pixel.data(), 1, 1, 1));
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    CHECK(thrown);
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 random(47);
+    test_box_matches_brute_force(random);
+    test_footprints(random);
+    test_box_sums(random);
+    return test::report("test_box");
+}
@@ -0,0 +1,115 @@
+#ifndef TEST_CHECK_H
+#define TEST_CHECK_H
+
+#include "image_view.h"
+#include <cstdio>
+#include <random>
+#include <vector>
+
+/**
+ * @brief Helpers shared by the test programs of make check.
+ *
+ * Each test is a program that runs its checks, prints the failed ones and returns a
+ * non-zero status if any failed.
+ */
+
+namespace test {
+
+/**
+ * @brief Returns the number of failed checks so far.
+ */
+inline int& failures() {
+    static int count = 0;
+    return count;
+}
+
+/**
+ * @brief Records a check, printing its description when it fails.
+ */
+inline void check(bool passed, const char* file, int line, const char* what) {
+    if (!passed) {
+        ++failures();
+        std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, what);
+    }
+}
+
+/**
+ * @brief Prints the outcome of a test program and returns its exit status.
+ */
+inline int report(const char* name) {
+    if (failures() == 0) {
+        std::printf("%s: passed\n", name);
+        return 0;
+    }
+    std::printf("%s: %d checks failed\n", name, failures());
+    return 1;
+}
+
+/**
+ * @brief Layouts the tests run the kernels on.
+ */
+enum class layout {
+    planar,         ///< One plane per channel, as CImg
+    interleaved,    ///< Interleaved pixels with padded rows
+    strided         ///< Interleaved pixels one pixel apart, so no fast path applies
+};
+
+/**
+ * @brief Image owning its pixels, viewed in one of the test layouts.
+ */
+struct image {
+    image(int width, int height, int spectrum, layout kind)
+        : pixels(static_cast<std::size_t>(2 * width + 2) * height * spectrum) {
+        switch (kind) {
+        case layout::planar:
+            view = image_view::planar(pixels.data(), width, height, spectrum);
+            break;
+        case layout::interleaved:
+            view = image_view::interleaved(pixels.data(), width, height, spectrum, static_cast<std::ptrdiff_t>(width + 2) * spectrum);
+            break;
+        case layout::strided:
+            view = image_view(pixels.data(), width, height, spectrum, 2 * spectrum, static_cast<std::ptrdiff_t>(2 * width + 2) * spectrum, 1);
+            break;
+        }
+    }
+
+    image(const image&) = delete;
+    image& operator=(const image&) = delete;
+
+    /**
+     * @brief Fills the image with random values below levels.
+     */
+    void randomize(std::mt19937& random, int levels = 256) {
+        for (int c = 0; c < view.spectrum; ++c) {
+            for (int y = 0; y < view.height; ++y) {
+                for (int x = 0; x < view.width; ++x) {
+                    view(x, y, c) = static_cast<unsigned char>(random() % levels);
+                }
+            }
+        }
+    }
+
+    std::vector<unsigned char> pixels;
+    image_view view;
+};
+
+/**
+ * @brief Counts the samples of two images of the same dimensions that differ.
+ */
+inline long differences(const const_image_view& a, const const_image_view& b) {
+    long count = 0;
+    for (int c = 0; c < a.spectrum; ++c) {
+        for (int y = 0; y < a.height; ++y) {
+            for (int x = 0; x < a.width; ++x) {
+                count += a(x, y, c) != b(x, y, c);
+            }
+        }
+    }
+    return count;
+}
+
+} // namespace test
+
+#define CHECK(condition) test::check((condition), __FILE__, __LINE__, #condition)
+
+#endif // TEST_CHECK_H
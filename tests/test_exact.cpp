@@ -0,0 +1,55 @@
+#include "test_check.h"
+#include "test_reference.h"
+#include "resize_bilinear.h"
+#include "resize_exact.h"
+#include "resize_nearest_neighbour.h"
+
+namespace {
+
+struct exact_case {
+    image_region region;
+    image_size size;
+};
+
+// Halving and doubling go through the integer kernels, which must give the samples of the
+// generic kernels, including at the capped last column and row of fractional regions
+void test_exact_matches_reference(std::mt19937& random) {
+    const test::layout layouts[] = {test::layout::planar, test::layout::interleaved, test::layout::strided};
+    const exact_case cases[] = {
+        {{0.0f, 0.0f, 96.0f, 64.0f}, {48, 32}},
+        {{1.0f, 3.0f, 64.0f, 50.0f}, {32, 25}},
+        {{3.0f, 2.0f, 6.0f, 4.0f}, {3, 2}},
+        {{0.0f, 0.0f, 97.0f, 65.0f}, {194, 130}},
+        {{2.0f, 3.0f, 5.5f, 3.5f}, {11, 7}},
+        {{96.0f, 64.0f, 1.0f, 1.0f}, {2, 2}},
+        {{0.0f, 10.0f, 97.0f, 1.0f}, {194, 2}},
+    };
+    resize_nearest_neighbour nearest;
+    resize_bilinear bilinear;
+    for (int spectrum : {1, 3, 4}) {
+        for (test::layout source_layout : layouts) {
+            test::image source(97, 65, spectrum, source_layout);
+            source.randomize(random);
+            for (const exact_case& exact : cases) {
+                CHECK(detect_exact_ratio(exact.region, exact.region.width / exact.size.width, exact.region.height / exact.size.height) != exact_ratio::none);
+                for (int kind = 0; kind < 2; ++kind) {
+                    resize_image_base& resizer = kind ? static_cast<resize_image_base&>(bilinear) : nearest;
+                    test::image expected(exact.size.width, exact.size.height, spectrum, test::layout::planar);
+                    test::image result(exact.size.width, exact.size.height, spectrum, layouts[random() % 3]);
+                    test::reference_resize(source.view, exact.region, expected.view, kind ? resize_kernels::bilinear_sample : resize_kernels::nearest_sample);
+                    resizer.set_tiling(random() % 2 ? tile_options{1024, 3} : tile_options());
+                    resizer.resize_region(source.view, exact.region, result.view);
+                    CHECK(test::differences(expected.view, result.view) == 0);
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 random(45);
+    test_exact_matches_reference(random);
+    return test::report("test_exact");
+}
@@ -0,0 +1,124 @@
+#include "test_check.h"
+#include "pixel_layout.h"
+#include "resize_job.h"
+#include <stdexcept>
+
+namespace {
+
+const test::layout layouts[] = {test::layout::planar, test::layout::interleaved, test::layout::strided};
+
+// Fills the first 3 channels of an image with the same random value per pixel, and any
+// further channel with unrelated values
+void fill_grey(test::image& image, std::mt19937& random) {
+    for (int y = 0; y < image.view.height; ++y) {
+        for (int x = 0; x < image.view.width; ++x) {
+            unsigned char grey = static_cast<unsigned char>(random());
+            for (int c = 0; c < image.view.spectrum; ++c) {
+                image.view(x, y, c) = c < 3 ? grey : static_cast<unsigned char>(random());
+            }
+        }
+    }
+}
+
+// A single differing sample anywhere, including in the tail of a row left to the scalar
+// loop, makes an image colour; other channels than the first 3 are ignored
+void test_is_grey(std::mt19937& random) {
+    for (int iteration = 0; iteration < 2000; ++iteration) {
+        int width = 1 + random() % 200;
+        int height = 1 + random() % 6;
+        test::image image(width, height, 3 + random() % 2, layouts[random() % 3]);
+        fill_grey(image, random);
+        CHECK(is_grey(image.view));
+        int x = random() % width;
+        int y = random() % height;
+        int c = 1 + random() % 2;
+        image.view(x, y, c) ^= static_cast<unsigned char>(1 + random() % 255);
+        CHECK(!is_grey(image.view));
+    }
+    test::image single(10, 10, 1, test::layout::planar);
+    CHECK(!is_grey(single.view));
+}
+
+void test_broadcast_grey(std::mt19937& random) {
+    for (test::layout kind : layouts) {
+        test::image image(77, 5, 4, kind);
+        image.randomize(random);
+        std::vector<unsigned char> alpha;
+        for (int y = 0; y < 5; ++y) {
+            for (int x = 0; x < 77; ++x) {
+                alpha.push_back(image.view(x, y, 3));
+            }
+        }
+        broadcast_grey(image.view);
+        CHECK(is_grey(image.view));
+        long changed = 0;
+        for (int y = 0; y < 5; ++y) {
+            for (int x = 0; x < 77; ++x) {
+                changed += image.view(x, y, 3) != alpha[y * 77 + x];
+            }
+        }
+        CHECK(changed == 0);
+    }
+    test::image single(4, 4, 1, test::layout::planar);
+    bool thrown = false;
+    try {
+        broadcast_grey(single.view);
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    CHECK(thrown);
+}
+
+// Resizing the first channel of a grey input, then broadcasting it or keeping it alone,
+// gives the channels of the colour resize for every method and orientation
+void test_grey_jobs(std::mt19937& random) {
+    for (test::layout kind : {test::layout::planar, test::layout::interleaved}) {
+        test::image source(301, 197, 3, kind);
+        fill_grey(source, random);
+        for (const char* method : {"nearest", "bilinear", "box", "max", "min", "mode"}) {
+            for (int orientation : {1, 3, 6}) {
+                for (bool keep_grey : {false, true}) {
+                    resize_job job;
+                    job.method = method;
+                    job.width = 123;
+                    job.height = 77;
+                    job.keep_grey = keep_grey;
+                    job_input grey;
+                    grey.pixels = source.view;
+                    grey.orientation = orientation;
+                    grey.grey = true;
+                    job_input colour;
+                    colour.pixels = source.view;
+                    colour.orientation = orientation;
+
+                    image_size size = job_output_size(job, grey);
+                    int spectrum = job_output_spectrum(job, grey);
+                    CHECK(spectrum == (keep_grey ? 1 : 3));
+                    test::image result(size.width, size.height, spectrum, test::layout::planar);
+                    test::image expected(size.width, size.height, 3, test::layout::planar);
+                    resize_job_into(job, grey, result.view);
+                    resize_job_into(job, colour, expected.view);
+                    long mismatches = 0;
+                    for (int c = 0; c < 3; ++c) {
+                        for (int y = 0; y < size.height; ++y) {
+                            for (int x = 0; x < size.width; ++x) {
+                                mismatches += result.view(x, y, std::min(c, spectrum - 1)) != expected.view(x, y, c);
+                            }
+                        }
+                    }
+                    CHECK(mismatches == 0);
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 random(50);
+    test_is_grey(random);
+    test_broadcast_grey(random);
+    test_grey_jobs(random);
+    return test::report("test_grey");
+}
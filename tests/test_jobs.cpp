@@ -0,0 +1,207 @@
+#include "test_check.h"
+#include "resize_job.h"
+#include "resize_client.h"
+#include "resize_server.h"
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+bool rejected(const resize_job& job) {
+    try {
+        validate_job(job);
+    } catch (const std::invalid_argument&) {
+        return true;
+    }
+    return false;
+}
+
+bool rejected_arguments(const std::vector<std::string>& args) {
+    try {
+        parse_job_arguments(args, resize_job());
+    } catch (const std::invalid_argument&) {
+        return true;
+    }
+    return false;
+}
+
+void test_validation() {
+    resize_job job;
+    CHECK(!rejected(job));
+    for (float scale : {0.0f, -1.0f, std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::infinity()}) {
+        job = resize_job();
+        job.scale = scale;
+        CHECK(rejected(job));
+    }
+    job = resize_job();
+    job.quality = 0;
+    CHECK(rejected(job));
+    job.quality = 101;
+    CHECK(rejected(job));
+    job = resize_job();
+    job.width = -1;
+    CHECK(rejected(job));
+    job.width = max_job_dimension + 1;
+    CHECK(rejected(job));
+    job = resize_job();
+    job.method = "cubic";
+    CHECK(rejected(job));
+
+    CHECK(rejected_arguments({"--scale", "nan"}));
+    CHECK(rejected_arguments({"--height", "100000"}));
+    CHECK(!rejected_arguments({"--scale", "0.5", "in.ppm", "out.ppm"}));
+}
+
+void test_output_size() {
+    resize_job job;
+    job.width = 100;
+    image_size size = job_output_size(job, 400, 300);
+    CHECK(size.width == 100 && size.height == 75);
+
+    job = resize_job();
+    job.scale = 1e9f;
+    bool thrown = false;
+    try {
+        job_output_size(job, 400, 300);
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    CHECK(thrown);
+}
+
+// Sends a job to the service without the checks of the command line, returning the error
+// it answers with, or an empty string
+std::string service_error(resize_client& client, const resize_job& job) {
+    try {
+        client.resize_file(job);
+    } catch (const std::runtime_error& error) {
+        return error.what();
+    }
+    return "";
+}
+
+void test_service() {
+    std::string directory = "/tmp/resize_test_jobs_" + std::to_string(getpid());
+    std::string socket_path = directory + ".sock";
+    std::string input = directory + "_in.ppm";
+    std::FILE* file = std::fopen(input.c_str(), "wb");
+    std::fprintf(file, "P6\n4 4\n255\n");
+    for (int i = 0; i < 48; ++i) {
+        std::fputc(i * 5, file);
+    }
+    std::fclose(file);
+    std::string grey_input = directory + "_grey.ppm";
+    file = std::fopen(grey_input.c_str(), "wb");
+    std::fprintf(file, "P6\n4 4\n255\n");
+    for (int i = 0; i < 48; ++i) {
+        std::fputc(i / 3 * 15, file);
+    }
+    std::fclose(file);
+
+    resize_server server(socket_path, 1, nullptr);
+    std::thread serving([&server]() { server.run(); });
+    {
+        resize_client client(socket_path);
+        resize_job job;
+        job.input = input;
+        job.output = directory + "_out.ppm";
+        job.width = 2;
+        job.height = 2;
+        CHECK(service_error(client, job).empty());
+
+        resize_job invalid = job;
+        invalid.width = 0;
+        invalid.height = 0;
+        invalid.scale = std::numeric_limits<float>::quiet_NaN();
+        CHECK(!service_error(client, invalid).empty());
+
+        invalid = job;
+        invalid.quality = 1000;
+        CHECK(!service_error(client, invalid).empty());
+
+        resize_job oversized = job;
+        oversized.width = max_job_dimension;
+        oversized.height = max_job_dimension;
+        CHECK(service_error(client, oversized).find("limited") != std::string::npos);
+
+        // The grey output choice travels with the request
+        resize_job grey = job;
+        grey.input = grey_input;
+        grey.output.clear();
+        CHECK(client.load_resized(grey).spectrum() == 3);
+        grey.keep_grey = true;
+        CHECK(client.load_resized(grey).spectrum() == 1);
+    }
+    server.stop();
+    serving.join();
+    std::remove(input.c_str());
+    std::remove(grey_input.c_str());
+    std::remove((directory + "_out.ppm").c_str());
+}
+
+// Cache keys tell apart scales differing in their last bit, and disk entries whose
+// dimensions do not match their size are ignored instead of allocated
+void test_cache() {
+    std::string directory = "/tmp/resize_test_cache_" + std::to_string(getpid());
+    std::string input = directory + "_in.ppm";
+    std::FILE* file = std::fopen(input.c_str(), "wb");
+    std::fprintf(file, "P6\n2 2\n255\n");
+    for (int i = 0; i < 12; ++i) {
+        std::fputc(i * 20, file);
+    }
+    std::fclose(file);
+
+    resize_job job;
+    job.input = input;
+    job.scale = 0.1f;
+    resize_job next = job;
+    next.scale = std::nextafter(0.1f, 1.0f);
+    CHECK(job_cache_key(job) != job_cache_key(next));
+
+    {
+        resize_cache cache(0, directory, 1 << 20);
+        cache.store("entry", cimg_library::CImg<unsigned char>(8, 4, 1, 3, 7));
+    }
+    {
+        resize_cache cache(0, directory, 1 << 20);
+        resize_cache::image_ptr image = cache.lookup("entry");
+        CHECK(image && image->width() == 8 && image->height() == 4 && image->spectrum() == 3);
+    }
+
+    // Dimensions of 64 GiB of pixels, then consistent ones over a truncated entry
+    std::string entry = directory + "/entry.rsz";
+    for (std::int32_t width : {1 << 16, 8}) {
+        std::int32_t dimensions[3] = {width, 1 << 16, 16};
+        if (width == 8) {
+            dimensions[1] = 4;
+            dimensions[2] = 3;
+            std::filesystem::resize_file(entry, std::filesystem::file_size(entry) - 1);
+        }
+        std::fstream header(entry, std::ios::binary | std::ios::in | std::ios::out);
+        header.seekp(4);
+        header.write(reinterpret_cast<const char*>(dimensions), sizeof(dimensions));
+        header.close();
+        resize_cache cache(0, directory, 1 << 20);
+        CHECK(!cache.lookup("entry"));
+    }
+    std::filesystem::remove_all(directory);
+    std::remove(input.c_str());
+}
+
+} // namespace
+
+int main() {
+    test_validation();
+    test_output_size();
+    test_service();
+    test_cache();
+    return test::report("test_jobs");
+}
@@ -0,0 +1,139 @@
+#include "test_check.h"
+#include "cimg_adapter.h"
+#include "pixel_layout.h"
+#include "resize_bilinear.h"
+#include "resize_nearest_neighbour.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace cimg_library;
+
+namespace {
+
+// The resizers as they were before the kernels moved onto image views: every sample of a
+// CImg image taken at x * ratio with its own nearest or bilinear estimate
+CImg<unsigned char> original_resize(const CImg<unsigned char>& source, int new_width, int new_height, bool bilinear) {
+    CImg<unsigned char> result(new_width, new_height, 1, source.spectrum(), 0);
+    float x_ratio = static_cast<float>(source.width()) / new_width;
+    float y_ratio = static_cast<float>(source.height()) / new_height;
+    cimg_forXYC(result, x, y, c) {
+        float src_x = x * x_ratio;
+        float src_y = y * y_ratio;
+        if (!bilinear) {
+            int nearest_x = std::max(0, std::min(static_cast<int>(std::round(src_x)), source.width() - 1));
+            int nearest_y = std::max(0, std::min(static_cast<int>(std::round(src_y)), source.height() - 1));
+            result(x, y, 0, c) = source(nearest_x, nearest_y, 0, c);
+            continue;
+        }
+        int x1 = static_cast<int>(src_x);
+        int y1 = static_cast<int>(src_y);
+        int x2 = std::min(x1 + 1, source.width() - 1);
+        int y2 = std::min(y1 + 1, source.height() - 1);
+        float x_frac = src_x - x1;
+        float y_frac = src_y - y1;
+        float top = source(x1, y1, 0, c) + x_frac * (source(x2, y1, 0, c) - source(x1, y1, 0, c));
+        float bottom = source(x1, y2, 0, c) + x_frac * (source(x2, y2, 0, c) - source(x1, y2, 0, c));
+        result(x, y, 0, c) = static_cast<unsigned char>(top + y_frac * (bottom - top));
+    }
+    return result;
+}
+
+void copy(const const_image_view& from, const image_view& to) {
+    for (int c = 0; c < from.spectrum; ++c) {
+        for (int y = 0; y < from.height; ++y) {
+            for (int x = 0; x < from.width; ++x) {
+                to(x, y, c) = from(x, y, c);
+            }
+        }
+    }
+}
+
+// Every layout of source and destination, and the CImg overloads, give the pixels of the
+// original resizers
+void test_layouts(std::mt19937& random) {
+    const test::layout layouts[] = {test::layout::planar, test::layout::interleaved, test::layout::strided};
+    const image_size sources[] = {{97, 61}, {64, 48}, {5, 3}, {1, 7}};
+    resize_nearest_neighbour nearest;
+    resize_bilinear bilinear;
+    for (int spectrum : {1, 3, 4}) {
+        for (image_size source_size : sources) {
+            CImg<unsigned char> original(source_size.width, source_size.height, 1, spectrum);
+            cimg_for(original, pixel, unsigned char) {
+                *pixel = static_cast<unsigned char>(random());
+            }
+            const image_size sizes[] = {{source_size.width * 3 / 2, source_size.height * 3 / 2}, {std::max(1, source_size.width / 2), std::max(1, source_size.height / 2)}, {source_size.width * 2, source_size.height * 2}, {40, 50}};
+            for (const resize_image_base* resizer : {static_cast<const resize_image_base*>(&nearest), static_cast<const resize_image_base*>(&bilinear)}) {
+                for (image_size size : sizes) {
+                    CImg<unsigned char> expected = original_resize(original, size.width, size.height, resizer == &bilinear);
+                    CHECK(test::differences(view_of(expected), view_of(resizer->resize(original, size.width, size.height))) == 0);
+                    for (test::layout source_layout : layouts) {
+                        test::image source(source_size.width, source_size.height, spectrum, source_layout);
+                        copy(view_of(original), source.view);
+                        for (test::layout destination_layout : layouts) {
+                            test::image destination(size.width, size.height, spectrum, destination_layout);
+                            resizer->resize(source.view, destination.view);
+                            CHECK(test::differences(view_of(expected), destination.view) == 0);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Interleaving and splitting runs of every length up to a few vector blocks, so that the
+// SIMD blocks, the scalar tails and the runs too short for any block are all covered, from
+// unaligned buffers and planes padded apart. Each pass matches the scalar definition
+// sample for sample and writes nothing past its run.
+void test_pixel_conversion(std::mt19937& random) {
+    const unsigned char guard = 0xA5;
+    const std::size_t margin = 32;
+    for (int channels = 1; channels <= 4; ++channels) {
+        for (std::size_t count = 0; count < 300; ++count) {
+            std::size_t offset = random() % 16;
+            std::ptrdiff_t plane_stride = static_cast<std::ptrdiff_t>(count + random() % 20);
+            std::size_t planar_bytes = offset + plane_stride * channels + margin;
+            std::vector<unsigned char> planar(planar_bytes);
+            for (unsigned char& sample : planar) {
+                sample = static_cast<unsigned char>(random());
+            }
+            const unsigned char* planes = planar.data() + offset;
+
+            std::vector<unsigned char> interleaved(offset + count * channels + margin, guard);
+            interleave_pixels(planes, plane_stride, count, channels, interleaved.data() + offset);
+            long mismatches = 0;
+            for (std::size_t i = 0; i < count; ++i) {
+                for (int c = 0; c < channels; ++c) {
+                    mismatches += interleaved[offset + i * channels + c] != planes[c * plane_stride + i];
+                }
+            }
+            for (std::size_t i = 0; i < offset; ++i) {
+                mismatches += interleaved[i] != guard;
+            }
+            for (std::size_t i = offset + count * channels; i < interleaved.size(); ++i) {
+                mismatches += interleaved[i] != guard;
+            }
+            CHECK(mismatches == 0);
+
+            // Back to planes, leaving the padding between them untouched
+            std::vector<unsigned char> split(planar_bytes, guard);
+            deinterleave_pixels(interleaved.data() + offset, count, channels, split.data() + offset, plane_stride);
+            mismatches = 0;
+            for (std::size_t i = 0; i < planar_bytes; ++i) {
+                bool inside = count > 0 && i >= offset && i - offset < static_cast<std::size_t>(plane_stride) * channels && (i - offset) % plane_stride < count;
+                mismatches += split[i] != (inside ? planar[i] : guard);
+            }
+            CHECK(mismatches == 0);
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 random(36);
+    test_layouts(random);
+    test_pixel_conversion(random);
+    return test::report("test_layouts");
+}
@@ -0,0 +1,169 @@
+#include "test_check.h"
+#include "cimg_adapter.h"
+#include "exif_orientation.h"
+#include "resize_bilinear.h"
+#include "resize_job.h"
+#include "resize_nearest_neighbour.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <unistd.h>
+
+using namespace cimg_library;
+
+namespace {
+
+// Writes the markers of a JPEG file up to its scan, with an EXIF block holding the
+// orientation tag in the given byte order after an unrelated tag
+std::string write_exif_header(int orientation, bool big_endian) {
+    auto put16 = [big_endian](std::string& out, int value) {
+        out += static_cast<char>(big_endian ? value >> 8 : value & 0xFF);
+        out += static_cast<char>(big_endian ? value & 0xFF : value >> 8);
+    };
+    auto put32 = [big_endian, put16](std::string& out, int value) {
+        put16(out, big_endian ? value >> 16 : value & 0xFFFF);
+        put16(out, big_endian ? value & 0xFFFF : value >> 16);
+    };
+    std::string tiff = big_endian ? "MM" : "II";
+    put16(tiff, 42);
+    put32(tiff, 8);
+    put16(tiff, 2);
+    for (int tag : {0x010F, 0x0112}) {
+        put16(tiff, tag);
+        put16(tiff, 3);
+        put32(tiff, 1);
+        put16(tiff, tag == 0x0112 ? orientation : 7);
+        put16(tiff, 0);
+    }
+
+    std::string payload = std::string("Exif\0\0", 6) + tiff;
+    std::string file = "\xFF\xD8";
+    file += "\xFF\xE0";
+    file += std::string("\x00\x04\x00\x00", 4);
+    file += "\xFF\xE1";
+    file += static_cast<char>((payload.size() + 2) >> 8);
+    file += static_cast<char>((payload.size() + 2) & 0xFF);
+    file += payload;
+    file += "\xFF\xDA";
+
+    std::string path = "/tmp/resize_test_orientation_" + std::to_string(getpid()) + ".jpg";
+    std::FILE* out = std::fopen(path.c_str(), "wb");
+    std::fwrite(file.data(), 1, file.size(), out);
+    std::fclose(out);
+    return path;
+}
+
+void test_read_orientation() {
+    for (bool big_endian : {false, true}) {
+        for (int orientation = 1; orientation <= 8; ++orientation) {
+            std::string path = write_exif_header(orientation, big_endian);
+            CHECK(read_exif_orientation(path) == orientation);
+            std::remove(path.c_str());
+        }
+    }
+    std::string path = write_exif_header(9, false);
+    CHECK(read_exif_orientation(path) == 1);
+    std::remove(path.c_str());
+    CHECK(read_exif_orientation("/nonexistent/image.jpg") == 1);
+}
+
+// Applies the operation displaying an image stored with the given orientation
+void orient(CImg<unsigned char>& image, int orientation) {
+    switch (orientation) {
+    case 2:
+        image.mirror('x');
+        break;
+    case 3:
+        image.rotate(180);
+        break;
+    case 4:
+        image.mirror('y');
+        break;
+    case 5:
+        image.permute_axes("yxzc");
+        break;
+    case 6:
+        image.rotate(90);
+        break;
+    case 7:
+        image.rotate(90).mirror('y');
+        break;
+    case 8:
+        image.rotate(-90);
+        break;
+    }
+}
+
+// Largest difference between the samples of two images of the same dimensions
+int largest_difference(const CImg<unsigned char>& a, const CImg<unsigned char>& b) {
+    int largest = 0;
+    cimg_forXYC(a, x, y, c) {
+        largest = std::max(largest, std::abs(a(x, y, 0, c) - b(x, y, 0, c)));
+    }
+    return largest;
+}
+
+// Warping with an orientation transform equals warping upright, then rotating or flipping
+// the result. Upright warps sample the positions of resize(), which computes them in float
+// instead of stepping them in double, so bilinear results may differ by a rounding.
+void test_transforms(std::mt19937& random) {
+    test::image source(97, 61, 3, test::layout::planar);
+    source.randomize(random);
+    CImg<unsigned char> stored(source.view.data, 97, 61, 1, 3, true);
+    resize_nearest_neighbour nearest;
+    resize_bilinear bilinear;
+    for (const resize_image_base* resizer : {static_cast<const resize_image_base*>(&nearest), static_cast<const resize_image_base*>(&bilinear)}) {
+        for (image_size size : {image_size{150, 100}, image_size{40, 30}, image_size{97, 61}}) {
+            CImg<unsigned char> upright = resizer->warp(stored, orientation_transform(1, 97, 61, size.width, size.height), size.width, size.height);
+            CImg<unsigned char> resized = resizer->resize(stored, size.width, size.height);
+            CHECK(largest_difference(upright, resized) <= (resizer == &nearest ? 0 : 1));
+            for (int orientation = 2; orientation <= 8; ++orientation) {
+                CImg<unsigned char> expected = upright;
+                orient(expected, orientation);
+                CImg<unsigned char> warped = resizer->warp(stored, orientation_transform(orientation, 97, 61, expected.width(), expected.height()), expected.width(), expected.height());
+                CHECK(test::differences(view_of(expected), view_of(warped)) == 0);
+            }
+        }
+    }
+}
+
+// Oriented jobs resize through a view of the destination in the stored orientation, so
+// every method keeps its own kernels: the result is exactly the upright resize of the same
+// method, rotated or flipped, in any destination layout
+void test_oriented_methods(std::mt19937& random) {
+    test::image source(97, 61, 3, test::layout::planar);
+    source.randomize(random);
+    CImg<unsigned char> stored(source.view.data, 97, 61, 1, 3, true);
+    for (const char* method : {"nearest", "bilinear", "box", "max", "min", "mode"}) {
+        std::unique_ptr<resize_image_base> resizer = create_resizer(method, tile_options());
+        for (image_size size : {image_size{150, 100}, image_size{40, 30}, image_size{97, 61}, image_size{48, 30}}) {
+            CImg<unsigned char> upright = resizer->resize(stored, size.width, size.height);
+            for (int orientation = 1; orientation <= 8; ++orientation) {
+                CImg<unsigned char> expected = upright;
+                orient(expected, orientation);
+                for (test::layout kind : {test::layout::planar, test::layout::interleaved, test::layout::strided}) {
+                    resize_job job;
+                    job.method = method;
+                    job_input input;
+                    input.pixels = source.view;
+                    input.orientation = orientation;
+                    test::image result(expected.width(), expected.height(), 3, kind);
+                    resize_job_into(job, input, result.view);
+                    CHECK(test::differences(view_of(expected), result.view) == 0);
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 random(28);
+    test_read_orientation();
+    test_transforms(random);
+    test_oriented_methods(random);
+    return test::report("test_orientation");
+}
@@ -0,0 +1,183 @@
+#include "test_check.h"
+#include "test_reference.h"
+#include "gaussian_prefilter.h"
+#include "resize_bilinear.h"
+#include "resize_job.h"
+#include "resize_nearest_neighbour.h"
+#include <cmath>
+
+namespace {
+
+// Largest distance from mid-grey of the samples of an image, leaving out a border of the
+// given width
+double largest_deviation(const const_image_view& image, int border) {
+    double largest = 0.0;
+    for (int c = 0; c < image.spectrum; ++c) {
+        for (int y = border; y < image.height - border; ++y) {
+            for (int x = border; x < image.width - border; ++x) {
+                largest = std::max(largest, std::abs(image(x, y, c) - 127.5));
+            }
+        }
+    }
+    return largest;
+}
+
+void test_blur() {
+    CHECK(gaussian_prefilter::sigma_for(0.5f) == 0.0f);
+    CHECK(gaussian_prefilter::sigma_for(1.0f) == 0.0f);
+    CHECK(gaussian_prefilter::sigma_for(5.0f) == 2.0f);
+
+    // A flat rectangle stays flat, whatever the blur
+    test::image flat(90, 70, 3, test::layout::interleaved);
+    for (int c = 0; c < 3; ++c) {
+        for (int y = 0; y < 70; ++y) {
+            for (int x = 0; x < 90; ++x) {
+                flat.view(x, y, c) = static_cast<unsigned char>(40 + 60 * c);
+            }
+        }
+    }
+    gaussian_prefilter prefilter;
+    const_image_view blurred = prefilter.apply(flat.view, 10, 5, 60, 50, 7.0f, 2.5f);
+    CHECK(blurred.width == 60 && blurred.height == 50 && blurred.spectrum == 3);
+    long changed = 0;
+    for (int c = 0; c < 3; ++c) {
+        for (int y = 0; y < 50; ++y) {
+            for (int x = 0; x < 60; ++x) {
+                changed += blurred(x, y, c) != 40 + 60 * c;
+            }
+        }
+    }
+    CHECK(changed == 0);
+}
+
+// A one-pixel checkerboard holds only frequencies far beyond those of the destination:
+// point samples of it alias to black and white, the prefiltered samples stay grey. The
+// blur repeats the edge pixels of the source, so the outermost destination pixels, sampling
+// the edges, are left out.
+void test_checkerboard() {
+    test::image source(400, 300, 3, test::layout::planar);
+    for (int c = 0; c < 3; ++c) {
+        for (int y = 0; y < 300; ++y) {
+            for (int x = 0; x < 400; ++x) {
+                source.view(x, y, c) = (x + y) % 2 ? 255 : 0;
+            }
+        }
+    }
+    resize_nearest_neighbour nearest;
+    resize_bilinear bilinear;
+    for (resize_image_base* resizer : {static_cast<resize_image_base*>(&nearest), static_cast<resize_image_base*>(&bilinear)}) {
+        test::image aliased(57, 43, 3, test::layout::planar);
+        resizer->set_antialiasing(false);
+        resizer->resize(source.view, aliased.view);
+        CHECK(largest_deviation(aliased.view, 1) > 100.0);
+
+        test::image filtered(57, 43, 3, test::layout::planar);
+        resizer->set_antialiasing(true);
+        resizer->resize(source.view, filtered.view);
+        CHECK(largest_deviation(filtered.view, 1) <= 1.0);
+    }
+}
+
+// A zone plate sweeps the frequencies from 0 at its centre to half the sampling rate at a
+// radius of 512: downscaled by 8, the rings beyond a radius of 160, above 2.5 times the
+// destination's limit, blur to grey away from the edges, while the centre keeps its
+// brightness
+void test_zone_plate() {
+    const double pi = 3.14159265358979323846;
+    test::image source(512, 512, 1, test::layout::planar);
+    for (int y = 0; y < 512; ++y) {
+        for (int x = 0; x < 512; ++x) {
+            double radius_squared = (x - 256.0) * (x - 256.0) + (y - 256.0) * (y - 256.0);
+            source.view(x, y, 0) = static_cast<unsigned char>(std::lround(127.5 + 127.5 * std::cos(pi * radius_squared / 1024.0)));
+        }
+    }
+    resize_nearest_neighbour nearest;
+    resize_bilinear bilinear;
+    for (resize_image_base* resizer : {static_cast<resize_image_base*>(&nearest), static_cast<resize_image_base*>(&bilinear)}) {
+        for (bool antialias : {false, true}) {
+            test::image result(64, 64, 1, test::layout::planar);
+            resizer->set_antialiasing(antialias);
+            resizer->resize(source.view, result.view);
+            double outer = 0.0;
+            for (int y = 0; y < 64; ++y) {
+                for (int x = 0; x < 64; ++x) {
+                    bool inside = x > 0 && y > 0 && x < 63 && y < 63;
+                    if (inside && std::hypot(x * 8 - 256.0, y * 8 - 256.0) >= 160.0) {
+                        outer = std::max(outer, std::abs(result.view(x, y, 0) - 127.5));
+                    }
+                }
+            }
+            if (antialias) {
+                CHECK(outer <= 3.0);
+                CHECK(result.view(32, 32, 0) >= 245);
+            } else {
+                CHECK(outer > 60.0);
+            }
+        }
+    }
+}
+
+// With antialiasing off, and with it on for resizes shrinking by 2 or less, the resizers
+// sample the source itself, byte for byte as the per-sample reference
+void test_unfiltered(std::mt19937& random) {
+    test::image source(241, 187, 3, test::layout::interleaved);
+    source.randomize(random);
+    resize_nearest_neighbour nearest;
+    resize_bilinear bilinear;
+    const image_region whole{0.0f, 0.0f, 241.0f, 187.0f};
+    for (image_size size : {image_size{30, 20}, image_size{121, 94}, image_size{300, 200}}) {
+        bool shrinks_little = size.width * 2 >= 241 && size.height * 2 >= 187;
+        for (bool antialias : {false, true}) {
+            if (antialias && !shrinks_little) {
+                continue;
+            }
+            test::image expected(size.width, size.height, 3, test::layout::planar);
+            test::image result(size.width, size.height, 3, test::layout::planar);
+            nearest.set_antialiasing(antialias);
+            nearest.resize(source.view, result.view);
+            test::reference_resize(source.view, whole, expected.view, resize_kernels::nearest_sample);
+            CHECK(test::differences(expected.view, result.view) == 0);
+
+            bilinear.set_antialiasing(antialias);
+            bilinear.resize(source.view, result.view);
+            test::reference_resize(source.view, whole, expected.view, resize_kernels::bilinear_sample);
+            CHECK(test::differences(expected.view, result.view) == 0);
+        }
+    }
+}
+
+// Jobs reach the prefilter through their antialias option, set by --antialias
+void test_jobs(std::mt19937& random) {
+    CHECK(!parse_job_arguments({"in.jpg", "out.jpg"}, resize_job()).antialias);
+    CHECK(parse_job_arguments({"--antialias", "in.jpg", "out.jpg"}, resize_job()).antialias);
+
+    test::image source(320, 200, 3, test::layout::planar);
+    source.randomize(random);
+    job_input input;
+    input.pixels = source.view;
+    for (bool antialias : {false, true}) {
+        resize_job job;
+        job.width = 40;
+        job.antialias = antialias;
+        test::image result(40, 25, 3, test::layout::planar);
+        resize_job_into(job, input, result.view);
+
+        resize_bilinear bilinear;
+        bilinear.set_antialiasing(antialias);
+        test::image expected(40, 25, 3, test::layout::planar);
+        bilinear.resize(source.view, expected.view);
+        CHECK(test::differences(expected.view, result.view) == 0);
+    }
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 random(48);
+    test_blur();
+    test_checkerboard();
+    test_zone_plate();
+    test_unfiltered(random);
+    test_jobs(random);
+    return test::report("test_prefilter");
+}
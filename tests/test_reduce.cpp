@@ -0,0 +1,87 @@
+#include "test_check.h"
+#include "resize_kernels.h"
+#include "resize_reduce.h"
+
+namespace {
+
+// Reduces a block of one channel by scanning it: the largest, the smallest or the most
+// frequent value, the smallest one on ties
+unsigned char brute_force_reduce(const const_image_view& source, int x0, int x1, int y0, int y1, int channel, reduction kind) {
+    int counts[256] = {};
+    int largest = 0;
+    int smallest = 255;
+    for (int y = y0; y < y1; ++y) {
+        for (int x = x0; x < x1; ++x) {
+            int value = source(x, y, channel);
+            ++counts[value];
+            largest = std::max(largest, value);
+            smallest = std::min(smallest, value);
+        }
+    }
+    if (kind == reduction::max) {
+        return static_cast<unsigned char>(largest);
+    }
+    if (kind == reduction::min) {
+        return static_cast<unsigned char>(smallest);
+    }
+    int mode = 0;
+    for (int value = 1; value < 256; ++value) {
+        if (counts[value] > counts[mode]) {
+            mode = value;
+        }
+    }
+    return static_cast<unsigned char>(mode);
+}
+
+// Images of 4 levels make mode ties and uniform blocks frequent, full-range ones exercise
+// the extremum folds
+void test_reduce_matches_brute_force(std::mt19937& random) {
+    const test::layout layouts[] = {test::layout::planar, test::layout::interleaved, test::layout::strided};
+    const reduction kinds[] = {reduction::max, reduction::min, reduction::mode};
+    for (int iteration = 0; iteration < 600; ++iteration) {
+        int width = 1 + random() % 90;
+        int height = 1 + random() % 70;
+        int spectrum = 1 + random() % 4;
+        test::image source(width, height, spectrum, layouts[random() % 3]);
+        source.randomize(random, random() % 2 ? 4 : 256);
+
+        image_region region{0.0f, 0.0f, static_cast<float>(width), static_cast<float>(height)};
+        if (iteration % 3) {
+            region.x = (random() % 1000) / 1000.0f * width / 2;
+            region.y = (random() % 1000) / 1000.0f * height / 2;
+            region.width = std::max(0.5f, (random() % 1000) / 1000.0f * (width - region.x));
+            region.height = std::max(0.5f, (random() % 1000) / 1000.0f * (height - region.y));
+        }
+        int new_width = 1 + random() % 40;
+        int new_height = 1 + random() % 40;
+        test::image result(new_width, new_height, spectrum, layouts[random() % 2]);
+        reduction kind = kinds[random() % 3];
+        resize_reduce reducer(kind);
+        reducer.set_tiling(tile_options{1 + random() % 4000, 1 + static_cast<int>(random() % 3)});
+        reducer.resize_region(source.view, region, result.view);
+
+        float x_end = std::min(region.x + region.width, static_cast<float>(width));
+        float y_end = std::min(region.y + region.height, static_cast<float>(height));
+        long mismatches = 0;
+        for (int y = 0; y < new_height; ++y) {
+            int y0, y1;
+            resize_kernels::footprint_edges(region.y, (y_end - region.y) / new_height, static_cast<int>(region.y), static_cast<int>(std::ceil(y_end)), y, y0, y1);
+            for (int x = 0; x < new_width; ++x) {
+                int x0, x1;
+                resize_kernels::footprint_edges(region.x, (x_end - region.x) / new_width, static_cast<int>(region.x), static_cast<int>(std::ceil(x_end)), x, x0, x1);
+                for (int c = 0; c < spectrum; ++c) {
+                    mismatches += result.view(x, y, c) != brute_force_reduce(source.view, x0, x1, y0, y1, c, kind);
+                }
+            }
+        }
+        CHECK(mismatches == 0);
+    }
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 random(49);
+    test_reduce_matches_brute_force(random);
+    return test::report("test_reduce");
+}
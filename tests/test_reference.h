@@ -0,0 +1,44 @@
+#ifndef TEST_REFERENCE_H
+#define TEST_REFERENCE_H
+
+#include "resize_image_base.h"
+#include "resize_kernels.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @brief Per-sample reference resizes the optimised kernels are checked against.
+ */
+
+namespace test {
+
+/**
+ * @brief Sampler of a reference resize, resize_kernels::nearest_sample or bilinear_sample.
+ */
+typedef unsigned char (*sampler)(const const_image_view&, float, float, int, edge_mode);
+
+/**
+ * @brief Resizes a region lying inside the source one sample at a time.
+ *
+ * Destination pixel (x, y) samples region.x + x * ratio, capped at the last column
+ * overlapping the region, and likewise vertically: the positions the resizers document.
+ */
+inline void reference_resize(const const_image_view& source, const image_region& region, const image_view& destination, sampler sample) {
+    float x_ratio = region.width / destination.width;
+    float y_ratio = region.height / destination.height;
+    float x_last = std::ceil(region.x + region.width) - 1;
+    float y_last = std::ceil(region.y + region.height) - 1;
+    for (int y = 0; y < destination.height; ++y) {
+        float src_y = std::min(region.y + y * y_ratio, y_last);
+        for (int x = 0; x < destination.width; ++x) {
+            float src_x = std::min(region.x + x * x_ratio, x_last);
+            for (int c = 0; c < destination.spectrum; ++c) {
+                destination(x, y, c) = sample(source, src_x, src_y, c, edge_mode::clamp);
+            }
+        }
+    }
+}
+
+} // namespace test
+
+#endif // TEST_REFERENCE_H
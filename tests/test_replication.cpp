@@ -0,0 +1,41 @@
+#include "test_check.h"
+#include "test_reference.h"
+#include "resize_nearest_neighbour.h"
+
+namespace {
+
+// Integer upscales replicate pixels and copy rows; every factor, region, layout and tile
+// boundary must give the samples of nearest_sample, including the shorter runs at the first
+// and last pixels of the region
+void test_replication_matches_reference(std::mt19937& random) {
+    const test::layout layouts[] = {test::layout::planar, test::layout::interleaved, test::layout::strided};
+    const image_region regions[] = {{0.0f, 0.0f, 41.0f, 23.0f}, {5.0f, 2.0f, 17.0f, 9.0f}, {3.5f, 1.0f, 12.5f, 6.0f}, {40.0f, 22.0f, 1.0f, 1.0f}};
+    resize_nearest_neighbour nearest;
+    for (int spectrum : {1, 2, 3, 4}) {
+        for (test::layout source_layout : layouts) {
+            test::image source(41, 23, spectrum, source_layout);
+            source.randomize(random);
+            for (const image_region& region : regions) {
+                for (float factor : {2.0f, 3.0f, 4.0f, 5.0f, 8.0f, 1.5f}) {
+                    image_size size{static_cast<int>(region.width * factor + 0.5f), static_cast<int>(region.height * factor + 0.5f)};
+                    for (test::layout destination_layout : layouts) {
+                        test::image expected(size.width, size.height, spectrum, test::layout::planar);
+                        test::image result(size.width, size.height, spectrum, destination_layout);
+                        test::reference_resize(source.view, region, expected.view, resize_kernels::nearest_sample);
+                        nearest.set_tiling(random() % 2 ? tile_options{1500, 3} : tile_options());
+                        nearest.resize_region(source.view, region, result.view);
+                        CHECK(test::differences(expected.view, result.view) == 0);
+                    }
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 random(46);
+    test_replication_matches_reference(random);
+    return test::report("test_replication");
+}
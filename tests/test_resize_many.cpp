@@ -0,0 +1,101 @@
+#include "test_check.h"
+#include "resize_bilinear.h"
+#include "resize_box.h"
+#include "resize_nearest_neighbour.h"
+#include "resize_reduce.h"
+#include <memory>
+
+namespace {
+
+// Resizes a source to all sizes at once and checks each against resize(), into
+// destinations of mixed layouts
+void check_many(const resize_image_base& resizer, const test::image& source, const std::vector<image_size>& sizes, std::mt19937& random) {
+    const test::layout layouts[] = {test::layout::planar, test::layout::interleaved, test::layout::strided};
+    int spectrum = source.view.spectrum;
+    std::vector<std::unique_ptr<test::image>> many;
+    std::vector<image_view> destinations;
+    for (const image_size& size : sizes) {
+        many.emplace_back(new test::image(size.width, size.height, spectrum, layouts[random() % 3]));
+        destinations.push_back(many.back()->view);
+    }
+    resizer.resize_many(source.view, destinations);
+    for (std::size_t i = 0; i < sizes.size(); ++i) {
+        test::image single(sizes[i].width, sizes[i].height, spectrum, test::layout::planar);
+        resizer.resize(source.view, single.view);
+        CHECK(test::differences(single.view, destinations[i]) == 0);
+    }
+}
+
+void test_every_method(std::mt19937& random) {
+    test::image source(173, 121, 3, test::layout::planar);
+    source.randomize(random);
+    std::vector<image_size> sizes = {{86, 60}, {40, 31}, {346, 242}, {173, 121}, {17, 200}};
+
+    std::vector<std::unique_ptr<resize_image_base>> resizers;
+    resizers.emplace_back(new resize_nearest_neighbour());
+    resizers.emplace_back(new resize_bilinear());
+    resizers.emplace_back(new resize_box());
+    resizers.emplace_back(new resize_reduce(reduction::mode));
+    for (const std::unique_ptr<resize_image_base>& resizer : resizers) {
+        check_many(*resizer, source, sizes, random);
+    }
+}
+
+// The single pass over the source rows of nearest neighbour and bilinear: sizes mixing
+// downscales skipping source rows, upscales reusing them, the exact halving, doubling and
+// replication ratios and single rows or columns, in every layout and spectrum
+void test_shared_pass(std::mt19937& random) {
+    const test::layout layouts[] = {test::layout::planar, test::layout::interleaved, test::layout::strided};
+    resize_nearest_neighbour nearest;
+    resize_bilinear bilinear;
+    for (int iteration = 0; iteration < 200; ++iteration) {
+        int width = 1 + random() % 120;
+        int height = 1 + random() % 90;
+        test::image source(width, height, 1 + random() % 4, layouts[random() % 3]);
+        source.randomize(random);
+        std::vector<image_size> sizes;
+        int count = 1 + random() % 6;
+        for (int i = 0; i < count; ++i) {
+            switch (random() % 4) {
+            case 0:
+                sizes.push_back({std::max(1, width / 2), std::max(1, height / 2)});
+                break;
+            case 1: {
+                int factor = 2 + random() % 3;
+                sizes.push_back({width * factor, height * factor});
+                break;
+            }
+            default:
+                sizes.push_back({1 + static_cast<int>(random() % (2 * width)), 1 + static_cast<int>(random() % (2 * height))});
+            }
+        }
+        check_many(nearest, source, sizes, random);
+        check_many(bilinear, source, sizes, random);
+    }
+}
+
+// Antialiasing and tile threads resize one size at a time, with the same results
+void test_fallbacks(std::mt19937& random) {
+    test::image source(240, 180, 3, test::layout::interleaved);
+    source.randomize(random);
+    std::vector<image_size> sizes = {{30, 20}, {120, 90}, {500, 61}};
+    resize_nearest_neighbour nearest;
+    resize_bilinear bilinear;
+    for (resize_image_base* resizer : {static_cast<resize_image_base*>(&nearest), static_cast<resize_image_base*>(&bilinear)}) {
+        resizer->set_antialiasing(true);
+        check_many(*resizer, source, sizes, random);
+        resizer->set_antialiasing(false);
+        resizer->set_tiling(tile_options{4096, 3});
+        check_many(*resizer, source, sizes, random);
+    }
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 random(29);
+    test_every_method(random);
+    test_shared_pass(random);
+    test_fallbacks(random);
+    return test::report("test_resize_many");
+}
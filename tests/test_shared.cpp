@@ -0,0 +1,88 @@
+#include "test_check.h"
+#include "resize_protocol.h"
+#include "shared_image.h"
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+int open_descriptors() {
+    int count = 0;
+    DIR* directory = opendir("/proc/self/fd");
+    while (readdir(directory)) {
+        ++count;
+    }
+    closedir(directory);
+    return count;
+}
+
+// Shared images cannot be shrunk by the peer they are handed to, and unsealed memory is
+// refused before it is mapped
+void test_sealing() {
+    shared_image image = shared_image::create(64, 32, 3);
+    CHECK(ftruncate(image.fd(), 16) < 0);
+    CHECK(ftruncate(image.fd(), 1 << 20) < 0);
+    shared_image adopted = shared_image::adopt(dup(image.fd()), 64, 32, 3, false);
+    CHECK(!adopted.empty());
+
+    int unsealed = memfd_create("unsealed", MFD_CLOEXEC);
+    CHECK(ftruncate(unsealed, 64 * 32 * 3) == 0);
+    bool thrown = false;
+    try {
+        shared_image::adopt(unsealed, 64, 32, 3, false);
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    CHECK(thrown);
+    CHECK(fcntl(unsealed, F_GETFD) < 0);
+}
+
+// A frame keeps the first of several attached descriptors and closes the others
+void test_extra_descriptors() {
+    int sockets[2];
+    CHECK(socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) == 0);
+    int before = open_descriptors();
+
+    int attached[3];
+    for (int& fd : attached) {
+        fd = memfd_create("attached", MFD_CLOEXEC);
+    }
+    resize_protocol::frame_header header{resize_protocol::frame_magic, resize_protocol::reply, 0, 0};
+    iovec part{&header, sizeof(header)};
+    msghdr message{};
+    message.msg_iov = &part;
+    message.msg_iovlen = 1;
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(attached))];
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+    cmsghdr* attachment = CMSG_FIRSTHDR(&message);
+    attachment->cmsg_level = SOL_SOCKET;
+    attachment->cmsg_type = SCM_RIGHTS;
+    attachment->cmsg_len = CMSG_LEN(sizeof(attached));
+    std::memcpy(CMSG_DATA(attachment), attached, sizeof(attached));
+    CHECK(sendmsg(sockets[0], &message, 0) == static_cast<ssize_t>(sizeof(header)));
+    for (int fd : attached) {
+        close(fd);
+    }
+
+    resize_protocol::frame received;
+    CHECK(resize_protocol::receive_frame(sockets[1], received));
+    CHECK(received.fd >= 0);
+    CHECK(open_descriptors() == before + 1);
+    close(received.fd);
+    close(sockets[0]);
+    close(sockets[1]);
+}
+
+} // namespace
+
+int main() {
+    test_sealing();
+    test_extra_descriptors();
+    return test::report("test_shared");
+}
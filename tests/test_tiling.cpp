@@ -0,0 +1,92 @@
+#include "test_check.h"
+#include "resize_job.h"
+#include "summed_area_table.h"
+#include "exif_orientation.h"
+
+namespace {
+
+// Tiles of a few hundred bytes cut rows into columns as well as bands
+const tile_options small_tiles{512, 3};
+
+const char* const methods[] = {"nearest", "bilinear", "box", "max", "min", "mode"};
+
+void test_resize(std::mt19937& random) {
+    test::image source(300, 170, 3, test::layout::interleaved);
+    source.randomize(random);
+    for (const char* method : methods) {
+        std::unique_ptr<resize_image_base> tiled = create_resizer(method, small_tiles);
+        for (image_size size : {image_size{97, 61}, image_size{640, 380}, image_size{300, 170}}) {
+            test::image expected(size.width, size.height, 3, test::layout::planar);
+            test::image result(size.width, size.height, 3, test::layout::planar);
+            resizer_for(method).resize_region(source.view, image_region{3.5f, 2.25f, 280.0f, 150.5f}, expected.view);
+            tiled->resize_region(source.view, image_region{3.5f, 2.25f, 280.0f, 150.5f}, result.view);
+            CHECK(test::differences(expected.view, result.view) == 0);
+        }
+    }
+}
+
+void test_summed_area_table(std::mt19937& random) {
+    test::image source(211, 133, 2, test::layout::planar);
+    source.randomize(random);
+    summed_area_table table(source.view);
+    test::image expected(70, 50, 2, test::layout::planar);
+    test::image result(70, 50, 2, test::layout::planar);
+    table.resize(expected.view);
+    table.resize(result.view, small_tiles);
+    CHECK(test::differences(expected.view, result.view) == 0);
+}
+
+// Orientation transforms step by whole pixels, so tiles sample exactly what full rows do
+void test_warp(std::mt19937& random) {
+    test::image source(190, 120, 3, test::layout::planar);
+    source.randomize(random);
+    for (const char* method : methods) {
+        std::unique_ptr<resize_image_base> tiled = create_resizer(method, small_tiles);
+        for (int orientation = 2; orientation <= 8; ++orientation) {
+            image_size size = orientation_swaps_axes(orientation) ? image_size{120, 190} : image_size{190, 120};
+            affine_transform transform = orientation_transform(orientation, source.view.width, source.view.height, size.width, size.height);
+            test::image expected(size.width, size.height, 3, test::layout::planar);
+            test::image result(size.width, size.height, 3, test::layout::planar);
+            resizer_for(method).warp(source.view, transform, expected.view);
+            tiled->warp(source.view, transform, result.view);
+            CHECK(test::differences(expected.view, result.view) == 0);
+        }
+    }
+}
+
+void test_job_tile_threads(std::mt19937& random) {
+    test::image source(150, 90, 3, test::layout::interleaved);
+    source.randomize(random);
+    job_input input;
+    input.pixels = source.view;
+    input.orientation = 6;
+    resize_job job = parse_job_arguments({"--method", "box", "--width", "45", "--tile-threads", "4"}, resize_job());
+    CHECK(job.tile_threads == 4);
+    image_size size = job_output_size(job, input);
+    test::image expected(size.width, size.height, 3, test::layout::planar);
+    test::image result(size.width, size.height, 3, test::layout::planar);
+    resize_job untiled = job;
+    untiled.tile_threads = 1;
+    resize_job_into(untiled, input, expected.view);
+    resize_job_into(job, input, result.view);
+    CHECK(test::differences(expected.view, result.view) == 0);
+
+    bool rejected = false;
+    try {
+        parse_job_arguments({"--tile-threads", "0"}, resize_job());
+    } catch (const std::invalid_argument&) {
+        rejected = true;
+    }
+    CHECK(rejected);
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 random(39);
+    test_resize(random);
+    test_summed_area_table(random);
+    test_warp(random);
+    test_job_tile_threads(random);
+    return test::report("test_tiling");
+}
@@ -0,0 +1,99 @@
+#include "test_check.h"
+#include "resize_bilinear.h"
+#include "resize_nearest_neighbour.h"
+#include <cmath>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+
+// Single-channel planar source whose last pixel is followed by an inaccessible page, so
+// that any read past the source faults instead of returning garbage
+struct guarded_source {
+    guarded_source(int width, int height) {
+        std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+        std::size_t bytes = static_cast<std::size_t>(width) * height;
+        std::size_t pages = (bytes + page - 1) / page;
+        mapping_size = (pages + 1) * page;
+        mapping = static_cast<unsigned char*>(mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+        mprotect(mapping + pages * page, page, PROT_NONE);
+        unsigned char* pixels = mapping + pages * page - bytes;
+        for (std::size_t i = 0; i < bytes; ++i) {
+            pixels[i] = static_cast<unsigned char>(i * 2654435761u >> 24);
+        }
+        view = const_image_view::planar(pixels, width, height, 1);
+    }
+
+    ~guarded_source() {
+        munmap(mapping, mapping_size);
+    }
+
+    unsigned char* mapping;
+    std::size_t mapping_size;
+    const_image_view view;
+};
+
+// Samples just under the last column and the last row, closer to it than float resolves
+void test_last_column_and_row() {
+    guarded_source source(4096, 2);
+    resize_bilinear bilinear;
+    resize_nearest_neighbour nearest;
+    std::vector<unsigned char> pixels(4);
+    image_view destination = image_view::planar(pixels.data(), 2, 2, 1);
+    for (const resize_image_base* resizer : {static_cast<const resize_image_base*>(&bilinear), static_cast<const resize_image_base*>(&nearest)}) {
+        resizer->warp(source.view, affine_transform{1.0, 0.0, 4095 - 3e-6, 0.0, 1.0, 0.0}, destination);
+        CHECK(pixels[0] == source.view(4095, 0, 0));
+        resizer->warp(source.view, affine_transform{1.0, 0.0, 100.0, 0.0, 1.0, 1 - 3e-6}, destination);
+        CHECK(pixels[0] == source.view(100, 1, 0));
+    }
+}
+
+// With the mirror and wrap edge modes every pixel is sampled, so the interior kernels must
+// match the edge-handling sampler on all of them
+void test_interior_matches_border(std::mt19937& random) {
+    test::image source(61, 47, 3, test::layout::planar);
+    source.randomize(random);
+    test::image destination(80, 70, 3, test::layout::planar);
+    resize_bilinear bilinear;
+    resize_nearest_neighbour nearest;
+    std::vector<affine_transform> transforms = {
+        affine_transform::rotation(0.3, 30.2, 23.7),
+        affine_transform::rotation(2.1, 30.2, 23.7),
+        affine_transform::scale(0.73, 0.61),
+        affine_transform::scale(1.37, 1.09),
+    };
+    for (edge_mode edges : {edge_mode::mirror, edge_mode::wrap}) {
+        bilinear.set_edge_mode(edges);
+        nearest.set_edge_mode(edges);
+        for (const affine_transform& transform : transforms) {
+            for (int kind = 0; kind < 2; ++kind) {
+                (kind ? static_cast<resize_image_base&>(bilinear) : nearest).warp(source.view, transform, destination.view);
+                long mismatches = 0;
+                for (int y = 0; y < destination.view.height; ++y) {
+                    double src_x = transform.xy * y + transform.x0;
+                    double src_y = transform.yy * y + transform.y0;
+                    for (int x = 0; x < destination.view.width; ++x) {
+                        for (int c = 0; c < 3; ++c) {
+                            float fx = static_cast<float>(src_x);
+                            float fy = static_cast<float>(src_y);
+                            unsigned char expected = kind ? resize_kernels::bilinear_sample(source.view, fx, fy, c, edges) : resize_kernels::nearest_sample(source.view, fx, fy, c, edges);
+                            mismatches += destination.view(x, y, c) != expected;
+                        }
+                        src_x += transform.xx;
+                        src_y += transform.yx;
+                    }
+                }
+                CHECK(mismatches == 0);
+            }
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 random(44);
+    test_last_column_and_row();
+    test_interior_matches_border(random);
+    return test::report("test_warp");
+}